@@ -0,0 +1,49 @@
+﻿#include "EAPDispatcher.h"
+#include "EAPInterfaceManager.h"
+
+EAPDispatcher::EAPDispatcher(const EAPInterfaceManager* manager)
+    : manager_(manager)
+{
+}
+
+EAPDispatcher::Route EAPDispatcher::route(const QString& interfaceKey, bool preferQueue) const
+{
+    const EapInterfaceMeta* meta = manager_ ? manager_->findInterface(interfaceKey) : nullptr;
+    if (!meta || !meta->enabled || meta->direction != QLatin1String("push"))
+        return Route::Drop;
+
+    const Route connected = preferQueue ? Route::Queue : Route::Send;
+    switch (mode_.load()) {
+    case Mode::Online:
+        return connected;
+    case Mode::SemiAuto:
+        // 半自动模式下链路在线，未允许的上报直接丢弃（入队会被立即补传，等同发送）
+        return (!meta->dispatchFlagsConfigured || meta->semiAutoEnabled) ? connected : Route::Drop;
+    case Mode::Offline:
+        break;
+    }
+
+    // 离线：上传队列已停止补传，入队的记录在重新上线后发送
+    if (meta->dispatchFlagsConfigured && meta->offlineEnabled)
+        return Route::Send;
+    const bool cacheable = meta->dispatchFlagsConfigured ? meta->offlineCache : preferQueue;
+    return (cacheable && cacheEnabled_.load()) ? Route::Queue : Route::Drop;
+}
+
+bool EAPDispatcher::allowsReplay(const QString& interfaceKey) const
+{
+    if (mode_.load() != Mode::SemiAuto)
+        return true;
+    const EapInterfaceMeta* meta = manager_ ? manager_->findInterface(interfaceKey) : nullptr;
+    return !meta || !meta->dispatchFlagsConfigured || meta->semiAutoEnabled;
+}
+
+const char* EAPDispatcher::routeName(Route route)
+{
+    switch (route) {
+    case Route::Send:  return "send";
+    case Route::Queue: return "queue";
+    case Route::Drop:  return "drop";
+    }
+    return "";
+}
@@ -0,0 +1,56 @@
+﻿#pragma once
+
+#include "eapcore_global.h"
+#include <QString>
+#include <atomic>
+
+class EAPInterfaceManager;
+
+/**
+ * @brief 上报分发策略：按当前 CIM 模式与接口的离线 / 半自动配置决定上报去向
+ *
+ * 接口配置（config_interfaces.merged.json）中的三个字段：
+ * - offlineEnabled ：离线（Local）时仍直接发送（如心跳、模式切换报告）
+ * - offlineCache   ：离线时写入上传队列，重新上线后补传（还需 eap.ini 离线缓存总开关打开）
+ * - semiAutoEnabled：半自动（Semi-Auto）模式下允许发送
+ * 接口未配置上述字段时沿用调用方给出的 preferQueue（旧的按主题判断）。
+ *
+ * 只给出去向，不组包；调用方在得到 Drop 时应直接返回，避免为不会发送的上报构造参数。
+ * 模式与开关可跨线程读写。
+ */
+class EAPCORE_EXPORT EAPDispatcher
+{
+public:
+    enum class Mode { Online, SemiAuto, Offline };
+    enum class Route { Send, Queue, Drop };
+
+    explicit EAPDispatcher(const EAPInterfaceManager* manager);
+
+    void setMode(Mode mode) { mode_.store(mode); }
+    Mode mode() const { return mode_.load(); }
+
+    // eap.ini 离线缓存总开关（INI_KEY_OFFLINE_CACHE）
+    void setCacheEnabled(bool enabled) { cacheEnabled_.store(enabled); }
+    bool cacheEnabled() const { return cacheEnabled_.load(); }
+
+    /**
+     * @brief 决定一次上报的去向
+     * @param interfaceKey 上行接口 key
+     * @param preferQueue  在线时是否经上传队列发送（批量、可补传的上报）；接口未配置离线字段时也作为离线缓存依据
+     * @return 未知、未启用或非 push 接口返回 Drop
+     */
+    Route route(const QString& interfaceKey, bool preferQueue = false) const;
+
+    /**
+     * @brief 上传队列中该接口的记录当前是否允许补传
+     * @return 半自动模式下配置了 semiAutoEnabled = false 的接口返回 false（记录留在队列中），其余返回 true
+     */
+    bool allowsReplay(const QString& interfaceKey) const;
+
+    static const char* routeName(Route route);
+
+private:
+    const EAPInterfaceManager* manager_;
+    std::atomic<Mode> mode_{ Mode::Offline };
+    std::atomic<bool> cacheEnabled_{ false };
+};
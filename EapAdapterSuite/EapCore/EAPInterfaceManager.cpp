@@ -1,5 +1,7 @@
 ﻿#include "EAPInterfaceManager.h"
 #include "JsonBuilder.h"
+#include "JsonTree.h"
+#include "JsonWriter.h"
 #include "VendorConfigLoader.h"
 #include "EAPMessageLogger.h"
 #include "EAPMessageRecord.h"
@@ -11,6 +13,15 @@
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
 
 #include "JsonParser.h"
 #include "LoggerInterface.h"
@@ -32,23 +43,18 @@
 */
 
 /**
- * @brief 按“点路径”在 QJsonObject 中设置嵌套字段的值
- * @param obj   原始 JSON 对象（按值传入，在其拷贝上进行修改）
+ * @brief 按“点路径”在构建树的对象结点下就地设置嵌套字段的值
+ * @param tree  构建树
+ * @param obj   起始对象结点（InvalidNode 表示该段未启用，忽略写入）
  * @param parts 通过 '.' 分割后的路径片段列表（如 ["header","user","name"]）
  * @param value 要设置的最终字段值
- * @return      设置完指定路径后的新 QJsonObject 对象
- */
-static QJsonObject setByDotPathObj(QJsonObject obj, const QStringList& parts, const QJsonValue& value) {
-    if (parts.isEmpty()) return obj;
-    const QString& key = parts.first();
-    if (parts.size() == 1) {
-        obj.insert(key, value);
-        return obj;
-    }
-    QJsonObject child = obj.value(key).toObject();
-    child = setByDotPathObj(child, parts.mid(1), value);
-    obj.insert(key, child);
-    return obj;
+ */
+static void setByDotPath(JsonTree& tree, JsonTree::NodeId obj, const QStringList& parts, const QJsonValue& value) {
+    if (obj == JsonTree::InvalidNode || parts.isEmpty()) return;
+    // 中间段不存在或不是对象时以空对象替换
+    for (int i = 0; i + 1 < parts.size(); ++i)
+        obj = tree.objectAt(obj, parts[i]);
+    tree.setValue(obj, parts.last(), value);
 }
 
 EAPInterfaceManager::EAPInterfaceManager(QObject* parent)
@@ -185,6 +191,81 @@ QString EAPInterfaceManager::getBaseUrl() const {
     return baseUrl;
 }
 
+/**
+ * @brief 获取指定接口的延迟统计快照（诊断用）
+ * @param interfaceKey 接口 key
+ * @return EapLatencyStats 样本数、超时次数、p50/p99 及当前生效超时；无样本时分位数为 0
+ */
+EapLatencyStats EAPInterfaceManager::latencyStats(const QString& interfaceKey) const {
+    EapLatencyStats stats;
+    const auto metaIt = interfaces.constFind(interfaceKey);
+    if (metaIt == interfaces.constEnd()) return stats;
+
+    std::lock_guard<std::mutex> lock(latencyMutex_);
+    const auto it = latencySketches_.constFind(interfaceKey);
+    if (it != latencySketches_.constEnd()) {
+        stats.samples = it->count();
+        stats.timeouts = it->timeouts();
+        stats.p50Ms = it->percentile(0.50);
+        stats.p99Ms = it->percentile(0.99);
+    }
+    stats.effectiveTimeoutMs = effectiveTimeoutLocked(interfaceKey, metaIt.value());
+    return stats;
+}
+
+/**
+ * @brief 获取指定接口当前生效的超时时间
+ * @param interfaceKey 接口 key
+ * @return int 生效超时（ms）；接口不存在时返回 0
+ */
+int EAPInterfaceManager::effectiveTimeoutMs(const QString& interfaceKey) const {
+    const auto metaIt = interfaces.constFind(interfaceKey);
+    if (metaIt == interfaces.constEnd()) return 0;
+
+    std::lock_guard<std::mutex> lock(latencyMutex_);
+    return effectiveTimeoutLocked(interfaceKey, metaIt.value());
+}
+
+/**
+ * @brief 记录一次请求延迟样本（已完成的请求）
+ * @param interfaceKey 接口 key
+ * @param elapsedMs    本次请求耗时（ms）
+ */
+void EAPInterfaceManager::recordLatency(const QString& interfaceKey, qint64 elapsedMs) {
+    std::lock_guard<std::mutex> lock(latencyMutex_);
+    latencySketches_[interfaceKey].record(elapsedMs);
+}
+
+/**
+ * @brief 记录一次请求超时（单独计数，不作为延迟样本）
+ * @param interfaceKey 接口 key
+ *
+ * 生效超时由 k × p99 推导，若把超时时长计入分位数，下一轮超时会放大 k 倍并逐轮累积到 max_ms，
+ * 对端失联时反而更晚发现；因此超时只计次数。
+ */
+void EAPInterfaceManager::recordTimeout(const QString& interfaceKey) {
+    std::lock_guard<std::mutex> lock(latencyMutex_);
+    latencySketches_[interfaceKey].recordTimeout();
+}
+
+/**
+ * @brief 按 adaptive_timeout 配置计算生效超时：clamp(k × p99, min_ms, max_ms)
+ * @param interfaceKey 接口 key
+ * @param meta         接口元数据
+ * @return int 生效超时（ms）；未启用或样本不足时返回 meta.timeoutMs
+ */
+int EAPInterfaceManager::effectiveTimeoutLocked(const QString& interfaceKey, const EapInterfaceMeta& meta) const {
+    const AdaptiveTimeout& at = meta.adaptiveTimeout;
+    if (!at.enabled) return meta.timeoutMs;
+
+    const auto it = latencySketches_.constFind(interfaceKey);
+    if (it == latencySketches_.constEnd() || it->count() < at.minSamples) return meta.timeoutMs;
+
+    const double scaled = at.k * static_cast<double>(it->percentile(0.99));
+    const int timeoutMs = static_cast<int>(std::ceil(scaled));
+    return std::max(at.minMs, std::min(timeoutMs, at.maxMs));
+}
+
 /**
  * @brief 获取当前已配置的接口数量
  * @return int 接口配置条目数量
@@ -210,6 +291,16 @@ EapInterfaceMeta& EAPInterfaceManager::getInterface(const QString& key) {
     return interfaces[key];
 }
 
+/**
+ * @brief 按接口 key 查找接口元数据（一次查找，用于判断存在性并只读访问）
+ * @param key 接口 key
+ * @return const EapInterfaceMeta* 找到时指向内部配置，未找到返回 nullptr
+ */
+const EapInterfaceMeta* EAPInterfaceManager::findInterface(const QString& key) const {
+    const auto it = interfaces.constFind(key);
+    return it == interfaces.constEnd() ? nullptr : &it.value();
+}
+
 /**
  * @brief 为指定接口组装最终要发送的 JSON 报文 payload
  * @param interfaceKey 接口 key（如 "CheckUser"、"UploadResult" 等）
@@ -223,31 +314,31 @@ QJsonObject EAPInterfaceManager::composePayloadForSend(const QString& interfaceK
 
     const EapInterfaceMeta& meta = interfaces.value(interfaceKey);
 
-    // 1) 构建 {header, body}
-    QJsonObject hb = JsonBuilder::buildPayload(meta, params);
+    // 1) 在构建树上装配 {header, body}；后续注入都就地写入同一棵树，最后一次性转换
+    JsonTree tree;
+    JsonBuilder::buildPayloadInto(meta, params, tree);
+    const JsonTree::NodeId headerNode = meta.enableHeader
+        ? tree.objectAt(tree.root(), QStringLiteral("header")) : JsonTree::InvalidNode;
+    const JsonTree::NodeId bodyNode = meta.enableBody
+        ? tree.objectAt(tree.root(), QStringLiteral("body")) : JsonTree::InvalidNode;
 
     // 2) 补充外部 header 参数
     if (meta.enableHeader)
     {
         const QVariantMap headerVals = headerBinder_.mergedParamsFor(interfaceKey, meta, QVariantMap{});
         if (!headerVals.isEmpty()) {
-            QJsonObject header = hb.value("header").toObject();
             for (auto it = meta.headerMap.begin(); it != meta.headerMap.end(); ++it) {
                 const QString localKey = it.key();
                 if (!headerVals.contains(localKey)) continue;
                 const QString jsonPath = it.value();
                 const QJsonValue val = QJsonValue::fromVariant(headerVals.value(localKey));
-                header = setByDotPathObj(header, jsonPath.split('.'), val);
+                setByDotPath(tree, headerNode, jsonPath.split('.'), val);
             }
-            hb.insert("header", header);
         }
     }
 
-    // 2.5) 新增：根据 internalDBMap 从内部数据缓存读取并注入
+    // 2.5) 新增：根据 internalDBMap 从内部数据缓存读取并注入（未启用的 header/body 段忽略写入）
     if (dataCache_ && dataCache_->isInitialized() && !meta.internalDBMap.isEmpty()) {
-        QJsonObject headerObj = hb.value("header").toObject(); 
-        QJsonObject bodyObj = hb.value("body").toObject();
-
         for (auto it = meta.internalDBMap.begin(); it != meta.internalDBMap.end(); ++it) {
             const QString jsonPath = it.key();       // 目标 JSON 路径（支持 header./body. 前缀）
             const QString readKeyPattern = it.value(); // 读取键模板（可含 {占位符}）
@@ -272,26 +363,23 @@ QJsonObject EAPInterfaceManager::composePayloadForSend(const QString& interfaceK
 
             if (path.startsWith("header.", Qt::CaseInsensitive)) {
                 QStringList parts = path.mid(QStringLiteral("header.").size()).split('.');
-                headerObj = setByDotPathObj(headerObj, parts, jv);
+                setByDotPath(tree, headerNode, parts, jv);
             }
             else if (path.startsWith("body.", Qt::CaseInsensitive)) {
                 QStringList parts = path.mid(QStringLiteral("body.").size()).split('.');
-                bodyObj = setByDotPathObj(bodyObj, parts, jv);
+                setByDotPath(tree, bodyNode, parts, jv);
             }
             else {
                 // 默认 body
                 QStringList parts = path.split('.');
-                bodyObj = setByDotPathObj(bodyObj, parts, jv);
+                setByDotPath(tree, bodyNode, parts, jv);
             }
         }
-
-        if (meta.enableHeader) hb.insert("header", headerObj);
-        if (meta.enableBody)   hb.insert("body", bodyObj);
     }
 
 
     // 3) 应用外壳包装（传入 interfaceKey 以支持 per-interface 配置）
-    const QJsonObject payload = EAPEnvelope::wrapOutgoing(hb, envelopeCfg, interfaceKey);
+    const QJsonObject payload = EAPEnvelope::wrapOutgoing(tree.toObject(), envelopeCfg, interfaceKey);
     return payload;
 }
 
@@ -310,8 +398,23 @@ void EAPInterfaceManager::post(const QString& interfaceKey, const QVariantMap& p
     // 取接口元数据 ＋ 构造最终 JSON 报文
     const EapInterfaceMeta& meta = interfaces.value(interfaceKey);
 
-    // 构造最终 payload
-    const QJsonObject payload = composePayloadForSend(interfaceKey, params); // 为指定接口组装最终要发送的 JSON 报文 payload
+    // 构造最终 payload，并只序列化一次（发送/重试/消息日志/调试日志共享同一份字节）
+    const EAPOutboundMessage message(composePayloadForSend(interfaceKey, params)); // 为指定接口组装最终要发送的 JSON 报文 payload
+
+    // pull 接口响应缓存 + single-flight：命中缓存直接回放结果，相同请求进行中则合并等待
+    QString flightKey;
+    if (meta.cacheTtlMs > 0 && meta.direction.compare("pull", Qt::CaseInsensitive) == 0) {
+        flightKey = responseCacheKey(interfaceKey, meta, message.payload());
+        if (serveFromCache(interfaceKey, flightKey)) {
+            return;
+        }
+        auto flight = inflightRequests_.find(flightKey);
+        if (flight != inflightRequests_.end()) {
+            ++flight.value(); // 合并到进行中的相同请求，完成时一并通知
+            return;
+        }
+        inflightRequests_.insert(flightKey, 0);
+    }
 
     // 写一条“发送记录”到消息日志数据库
     if (messageLogger_ && messageLogger_->isInitialized()) {
@@ -320,28 +423,32 @@ void EAPInterfaceManager::post(const QString& interfaceKey, const QVariantMap& p
         record.type = EAPMessageRecord::InterfaceManagerSent;
         record.interfaceKey = interfaceKey;
         record.interfaceDescription = meta.m_interface_description;
-        record.payload = payload;
+        record.payload = message.payload();
+        record.payloadBytes = message.bytes();
         record.isSuccess = true;
         messageLogger_->insertRecord(record);
     }
 
-    // 写一条文件日志（spdlog）
-    LOG_TYPE_DEBUG("MES", "post  [{}]", QJsonDocument(payload).toJson().toStdString().c_str());
+    // 写一条文件日志（spdlog），仅在 debug 级别开启时格式化
+    if (LOG_TYPE_DEBUG_ENABLED("MES")) {
+        LOG_TYPE_DEBUG("MES", "post  [{}]", message.bytes().constData());
+    }
 
-    emit requestSent(interfaceKey, payload); // 发出 “已发出请求” 信号
+    emit requestSent(interfaceKey, message.payload()); // 发出 “已发出请求” 信号
 
-    postWithRetry(interfaceKey, meta, payload, meta.retryCount);
+    postWithRetry(interfaceKey, meta, message, meta.retryCount, flightKey);
 }
 
 /**
  * @brief 发送 HTTP 请求并按配置执行超时控制、自动重试、响应解析与结果缓存
  * @param interfaceKey 当前请求的接口 key
  * @param meta         对应接口的元数据配置（URL、method、headers、重试/缓存策略等）
- * @param payload      由 composePayloadForSend() 组装好的最终请求 JSON
+ * @param message      由 composePayloadForSend() 组装并已序列化的出网报文（各次重试共享同一份字节）
  * @param retriesLeft  剩余重试次数（初始值通常为 meta.retryCount）
+ * @param flightKey    响应缓存/single-flight 键（为空表示未启用缓存）
  */
 void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapInterfaceMeta& meta,
-    const QJsonObject& payload, int retriesLeft)
+    const EAPOutboundMessage& message, int retriesLeft, const QString& flightKey)
 {
     // 优先使用 endpoint，否则拼接 baseUrl + name
     QNetworkRequest request(QUrl((meta.endpoint.isEmpty() ? (baseUrl + meta.name) : meta.endpoint))); // 如果 meta.endpoint 有值：直接用它做完整 URL
@@ -353,42 +460,40 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
         request.setRawHeader(it.key().toUtf8(), it.value().toUtf8());
     }
 
-    // 复用网络管理器，根据 method 选择不同的 HTTP 方法
-    QNetworkReply* reply = nullptr;
-    QByteArray payloadBytes = QJsonDocument(payload).toJson(QJsonDocument::Compact);
-    
-    // 根据 method 选择 GET/POST/PUT/DELETE
-    const QString method = meta.method.toUpper();
-    if (method == "GET") {
-        reply = networkManager_->get(request);
-    } else if (method == "PUT") {
-        reply = networkManager_->put(request, payloadBytes);
-    } else if (method == "DELETE") {
-        reply = networkManager_->deleteResource(request);
-    } else {
-        // 默认 POST
-        reply = networkManager_->post(request,  payloadBytes);
-    }
+    // 本次尝试的生效超时（自适应超时启用时由延迟分位数推导）
+    const int timeoutMs = effectiveTimeoutMs(interfaceKey);
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    // 复用网络管理器，根据 method 选择不同的 HTTP 方法（复用已序列化字节，重试/对冲不再重新序列化）
+    QNetworkReply* reply = sendRequest(request, meta.method, message.bytes());
+    const QPointer<QNetworkReply> primary(reply);
 
-    // 构建“单次请求”的超时定时器 + 超时标记
+    // 对冲请求（仅 pull 方向且配置了 hedge 策略时登记，延迟为 0 表示本次不对冲）
+    const int hedgeDelayMs = prepareHedge(interfaceKey, meta, timeoutMs);
+    QSharedPointer<QPointer<QNetworkReply>> hedgeReply = QSharedPointer<QPointer<QNetworkReply>>::create();
+
+    // 构建“单次请求”的超时定时器 + 结束标记（超时或任一路请求已给出结果）
     QTimer* timer = new QTimer(this);
     timer->setSingleShot(true);
 
-    //bool* timeoutFlag = new bool(false);
-    QSharedPointer<bool> timeoutFlag = QSharedPointer<bool>::create(false);
+    QSharedPointer<bool> settled = QSharedPointer<bool>::create(false);
 
     // 超时处理逻辑（timeout 回调）
     connect(timer, &QTimer::timeout, this, [=]() {
-        if (reply->isRunning()) {
-            *timeoutFlag = true;
-            reply->abort();
+        if (!*settled) {
+            *settled = true;
+            if (primary && primary->isRunning()) primary->abort();
+            if (*hedgeReply && (*hedgeReply)->isRunning()) (*hedgeReply)->abort();
+            timer->deleteLater();
+            recordTimeout(interfaceKey); // 超时只计次数，不计入延迟分位数
             if (retriesLeft > 0) {
                 QTimer::singleShot(100, this, [=]() {
-                    postWithRetry(interfaceKey, meta, payload, retriesLeft - 1);
+                    postWithRetry(interfaceKey, meta, message, retriesLeft - 1, flightKey);
                     });
             }
             else {
-                QString errorMsg = tr("请求超时 (%1 ms)").arg(meta.timeoutMs * (meta.retryCount + 1));
+                QString errorMsg = tr("请求超时 (%1 ms)").arg(timeoutMs * (meta.retryCount + 1));
                 
                 // 记录失败的请求
                 if (messageLogger_ && messageLogger_->isInitialized()) {
@@ -405,19 +510,39 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
                 }
                 LOG_TYPE_DEBUG("MES", "post  [{}]", errorMsg.toStdString().c_str());
                 emit requestFailed(interfaceKey, errorMsg);
+                failFlight(flightKey, interfaceKey, errorMsg);
             }
         }
         });
 
-    // 正常完成回调（reply->finished）
-    connect(reply, &QNetworkReply::finished, this, [=]() {
-        timer->stop();
+    // 完成回调（主请求与对冲请求共用，先给出结果者胜出，另一路被中止）
+    auto onFinished = [=](QNetworkReply* r) {
+        if (*settled) {
+            // 超时已处理（已重试或上报），或另一路已胜出
+            r->deleteLater();
+            return;
+        }
+
+        QNetworkReply* other = (r == reply) ? hedgeReply->data() : primary.data();
+        if (r->error() != QNetworkReply::NoError && other && other->isRunning()) {
+            // 本路网络错误但另一路仍在进行：等待另一路结果
+            r->deleteLater();
+            return;
+        }
 
-        if (*timeoutFlag) {
-            // 超时已处理（已重试或上报）
+        *settled = true;
+        timer->stop();
+        if (other && other->isRunning()) {
+            other->abort(); // 中止落后的一路（其 finished 将直接回收）
         }
-        else {
-            QByteArray raw = reply->readAll();
+
+        {
+            if (r->error() == QNetworkReply::NoError) {
+                // 主请求胜出：记录其自身延迟；对冲胜出：记录主请求截至此刻的耗时（删失样本，真实延迟不小于此值）。
+                // 不记录被中止的主请求会使分位数偏低，进而缩短对冲延迟与自适应超时，形成正反馈
+                recordLatency(interfaceKey, elapsed.elapsed());
+            }
+            QByteArray raw = r->readAll();
             QJsonParseError err{};
             QJsonDocument doc = QJsonDocument::fromJson(raw, &err);
 
@@ -425,7 +550,7 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
             if (err.error != QJsonParseError::NoError || !doc.isObject()) {
                 if (retriesLeft > 0) {
                     QTimer::singleShot(100, this, [=]() {
-                        postWithRetry(interfaceKey, meta, payload, retriesLeft - 1);
+                        postWithRetry(interfaceKey, meta, message, retriesLeft - 1, flightKey);
                         });
                 }
                 else {
@@ -446,6 +571,7 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
                     }
                     LOG_TYPE_DEBUG("MES", "post  [{}]", errorMsg.toStdString().c_str());
                     emit requestFailed(interfaceKey, errorMsg);
+                    failFlight(flightKey, interfaceKey, errorMsg);
                 }
             } // 情况 B：解析成功，记录响应 + 发信号
             else {
@@ -463,7 +589,9 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
                     messageLogger_->insertRecord(record);
                   
                 }
-                LOG_TYPE_DEBUG("MES", "response  [{}]", QJsonDocument(obj).toJson().toStdString().c_str());
+                if (LOG_TYPE_DEBUG_ENABLED("MES")) {
+                    LOG_TYPE_DEBUG("MES", "response  [{}]", raw.constData()); // 直接记录原始响应字节，不再重新格式化
+                }
                 emit responseReceived(interfaceKey, obj);
 
                 // 归一化响应：{in_head,in_body} -> {header,body}（传入 interfaceKey）
@@ -479,7 +607,7 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
                 if (retriesLeft > 0 && shouldRetryBasedOnResponse(meta, parsed1)) {
                     // 响应指示需要重试，延迟后重试
                     QTimer::singleShot(100, this, [=]() {
-                        postWithRetry(interfaceKey, meta, payload, retriesLeft - 1);
+                        postWithRetry(interfaceKey, meta, message, retriesLeft - 1, flightKey);
                     });
                     return; // 不继续处理，等待重试
                 }
@@ -586,9 +714,8 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
 
                                 if (!keys.isEmpty()) {
                                     // 预先把要保存的数据转换一次（避免在 lambda 中重复转换）
-                                    QVariantMap payloadMap = normalized.toVariantMap();
-                                    // 捕获 functionNameFromConfig、keys、payloadMap（通过拷贝或 move）
-                                    QMetaObject::invokeMethod(this, [this, functionNameFromConfig, keys, payloadMap]() mutable {
+                                    const QVariantMap payloadMap = normalized.toVariantMap();
+                                    QMetaObject::invokeMethod(this, [this, functionNameFromConfig, keys, payloadMap]() {
                                         std::lock_guard<std::mutex> lock(cacheMutex_);
                                         if (!dataCache_ || !dataCache_->isInitialized()) return;
                                         for (const QString& key : keys) {
@@ -605,15 +732,270 @@ void EAPInterfaceManager::postWithRetry(const QString& interfaceKey, const EapIn
 
                 // 通知上层映射后的结果
                 emit mappedResultReady(interfaceKey, parsed1);
+
+                // 响应缓存 + 唤醒合并到本次请求的等待者（业务失败的响应不缓存）
+                finishFlight(flightKey, interfaceKey, meta, obj, parsed1,
+                    !flightKey.isEmpty() && isSuccessResponse(meta, obj, normalized));
             }
         }
 
         
-        reply->deleteLater();
+        r->deleteLater();
         timer->deleteLater();
-        });
+        };
+
+    connect(reply, &QNetworkReply::finished, this, [=]() { onFinished(reply); });
+
+    if (hedgeDelayMs > 0) {
+        QTimer::singleShot(hedgeDelayMs, this, [=]() {
+            if (*settled || !primary || !primary->isRunning()) return;
+            if (!acquireHedgeToken(interfaceKey)) return; // 对冲配额用尽（如故障期），不再放大负载
+
+            QNetworkReply* hedge = sendRequest(request, meta.method, message.bytes());
+            *hedgeReply = hedge;
+            LOG_TYPE_DEBUG("MES", "hedge  [{}] after {} ms", interfaceKey.toStdString().c_str(), hedgeDelayMs);
+            connect(hedge, &QNetworkReply::finished, this, [=]() { onFinished(hedge); });
+            });
+    }
+
+    timer->start(timeoutMs);
+}
+
+/**
+ * @brief 计算响应缓存键：接口 key + 去除易变字段后的规范化报文哈希
+ *
+ * QJsonObject 键天然有序，紧凑序列化即为规范形式；易变字段（trx_id/time_stamp 等）
+ * 在任意层级按键名剔除，避免每次请求的流水号、时间戳导致缓存失效。
+ * @param interfaceKey 接口 key
+ * @param meta         接口元数据（cache_ignore_fields 为空时使用默认易变字段）
+ * @param payload      最终出网报文
+ * @return QString     缓存键
+ */
+QString EAPInterfaceManager::responseCacheKey(const QString& interfaceKey, const EapInterfaceMeta& meta, const QJsonObject& payload) const
+{
+    static const QStringList kDefaultVolatile = { "trx_id", "time_stamp", "timestamp" };
+    const QStringList& ignore = meta.cacheIgnoreFields.isEmpty() ? kDefaultVolatile : meta.cacheIgnoreFields;
+
+    const std::function<QJsonValue(const QJsonValue&)> strip = [&](const QJsonValue& v) -> QJsonValue {
+        if (v.isObject()) {
+            QJsonObject o;
+            const QJsonObject in = v.toObject();
+            for (auto it = in.begin(); it != in.end(); ++it) {
+                if (ignore.contains(it.key(), Qt::CaseInsensitive)) continue;
+                o.insert(it.key(), strip(it.value()));
+            }
+            return o;
+        }
+        if (v.isArray()) {
+            QJsonArray a;
+            for (const QJsonValue& x : v.toArray()) a.append(strip(x));
+            return a;
+        }
+        return v;
+        };
+
+    const QByteArray canonical = JsonWriter::toJson(strip(payload).toObject());
+    return interfaceKey + '#' + QString::fromLatin1(QCryptographicHash::hash(canonical, QCryptographicHash::Sha1).toHex());
+}
+
+/**
+ * @brief 若缓存未过期则异步回放缓存结果（responseReceived + mappedResultReady）
+ * @param interfaceKey 接口 key
+ * @param flightKey    缓存键
+ * @return true 表示已命中缓存
+ */
+bool EAPInterfaceManager::serveFromCache(const QString& interfaceKey, const QString& flightKey)
+{
+    auto it = responseCache_.find(flightKey);
+    if (it == responseCache_.end()) return false;
+    if (it->expiresAtMs <= QDateTime::currentMSecsSinceEpoch()) {
+        responseCache_.erase(it);
+        return false;
+    }
+
+    const QJsonObject raw = it->response;
+    const QVariantMap mapped = it->mapped;
+    LOG_TYPE_DEBUG("MES", "cache hit  [{}]", interfaceKey.toStdString().c_str());
+    // 排队发出，保持与网络请求一致的异步语义
+    QMetaObject::invokeMethod(this, [this, interfaceKey, raw, mapped]() {
+        emit responseReceived(interfaceKey, raw);
+        emit mappedResultReady(interfaceKey, mapped);
+        }, Qt::QueuedConnection);
+    return true;
+}
+
+/**
+ * @brief 收到响应：业务成功时写入响应缓存，并为合并等待者补发结果
+ * @param flightKey    缓存键（为空直接返回）
+ * @param interfaceKey 接口 key
+ * @param meta         接口元数据（读取 cacheTtlMs）
+ * @param response     原始响应
+ * @param mapped       映射后的结果
+ * @param cacheable    是否写入缓存（业务 NG 等失败响应只补发给等待者，不缓存）
+ */
+void EAPInterfaceManager::finishFlight(const QString& flightKey, const QString& interfaceKey, const EapInterfaceMeta& meta,
+    const QJsonObject& response, const QVariantMap& mapped, bool cacheable)
+{
+    if (flightKey.isEmpty()) return;
+
+    if (cacheable) {
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (responseCache_.size() >= 256) {
+            // 顺带清理过期项，防止缓存无限增长
+            for (auto it = responseCache_.begin(); it != responseCache_.end();) {
+                if (it->expiresAtMs <= now) it = responseCache_.erase(it);
+                else ++it;
+            }
+        }
+        CachedResponse entry;
+        entry.response = response;
+        entry.mapped = mapped;
+        entry.expiresAtMs = now + meta.cacheTtlMs;
+        responseCache_.insert(flightKey, entry);
+    }
+
+    const int waiters = inflightRequests_.take(flightKey);
+    for (int i = 0; i < waiters; ++i) {
+        emit responseReceived(interfaceKey, response);
+        emit mappedResultReady(interfaceKey, mapped);
+    }
+}
+
+/**
+ * @brief 请求最终失败：结束 single-flight，并向合并等待者补发失败
+ * @param flightKey    缓存键（为空直接返回）
+ * @param interfaceKey 接口 key
+ * @param errorMsg     失败原因
+ */
+void EAPInterfaceManager::failFlight(const QString& flightKey, const QString& interfaceKey, const QString& errorMsg)
+{
+    if (flightKey.isEmpty()) return;
+
+    const int waiters = inflightRequests_.take(flightKey);
+    for (int i = 0; i < waiters; ++i) {
+        emit requestFailed(interfaceKey, errorMsg);
+    }
+}
+
+/**
+ * @brief 按 method 发出一次 HTTP 请求（GET/POST/PUT/DELETE）
+ * @param request 已设置 URL 与请求头的请求对象
+ * @param method  接口配置中的 method（大小写不敏感，未知值按 POST 处理）
+ * @param body    已序列化的请求体
+ * @return QNetworkReply* 网络应答对象（由调用方负责回收）
+ */
+QNetworkReply* EAPInterfaceManager::sendRequest(const QNetworkRequest& request, const QString& method, const QByteArray& body)
+{
+    // 根据 method 选择 GET/POST/PUT/DELETE
+    const QString m = method.toUpper();
+    if (m == "GET") {
+        return networkManager_->get(request);
+    } else if (m == "PUT") {
+        return networkManager_->put(request, body);
+    } else if (m == "DELETE") {
+        return networkManager_->deleteResource(request);
+    }
+    // 默认 POST
+    return networkManager_->post(request, body);
+}
+
+/**
+ * @brief 登记一次主请求并计算对冲延迟
+ *
+ * 仅 direction 为 pull 且配置了 hedge 策略的接口参与对冲。每次主请求按 max_ratio
+ * 累积对冲配额（上限 1 次），对冲请求消耗 1 次配额，从而限制对冲请求占比。
+ * @param interfaceKey 接口 key
+ * @param meta         接口元数据
+ * @param timeoutMs    本次尝试的生效超时
+ * @return int 对冲延迟（ms）；0 表示本次不对冲
+ */
+int EAPInterfaceManager::prepareHedge(const QString& interfaceKey, const EapInterfaceMeta& meta, int timeoutMs)
+{
+    const HedgePolicy& hp = meta.hedgePolicy;
+    if (!hp.isEnabled() || meta.direction.compare("pull", Qt::CaseInsensitive) != 0) return 0;
+
+    // 对冲配额（仅在管理器线程访问，首次使用时允许 1 次对冲）
+    auto tokenIt = hedgeTokens_.find(interfaceKey);
+    if (tokenIt == hedgeTokens_.end()) tokenIt = hedgeTokens_.insert(interfaceKey, 1.0);
+    tokenIt.value() = qMin(1.0, tokenIt.value() + hp.maxRatio);
+
+    int delayMs = 0;
+    if (hp.atPercentile > 0.0) {
+        std::lock_guard<std::mutex> lock(latencyMutex_);
+        const auto it = latencySketches_.constFind(interfaceKey);
+        if (it != latencySketches_.constEnd() && it->count() >= hp.minSamples) {
+            delayMs = it->percentile(hp.atPercentile);
+        }
+    }
+    if (delayMs <= 0) delayMs = hp.afterMs; // 样本不足时回退到固定延迟
+
+    return (delayMs > 0 && delayMs < timeoutMs) ? delayMs : 0;
+}
+
+/**
+ * @brief 尝试消耗一次对冲配额
+ * @param interfaceKey 接口 key
+ * @return true 表示允许发出对冲请求
+ */
+bool EAPInterfaceManager::acquireHedgeToken(const QString& interfaceKey)
+{
+    auto it = hedgeTokens_.find(interfaceKey);
+    if (it == hedgeTokens_.end() || it.value() < 1.0) return false;
+    it.value() -= 1.0;
+    return true;
+}
+
+/**
+ * @brief 按接口的 successPolicy 判定响应是否业务成功
+ * @param meta       接口元数据（读取 successPolicy）
+ * @param response   原始响应（path 可写原始字段，如 response_head.result）
+ * @param normalized 归一化后的响应（path 可写 header.result / body.xxx）
+ * @return true 表示业务成功；未配置策略时按 header.result 判定，缺失视为成功
+ */
+bool EAPInterfaceManager::isSuccessResponse(const EapInterfaceMeta& meta, const QJsonObject& response, const QJsonObject& normalized) const
+{
+    const SuccessPolicy& policy = meta.successPolicy;
+    const QString type = policy.type.trimmed().toLower();
+    if (type == "always") return true;
+
+    // 先按原始响应解析 path，取不到再按归一化结构解析
+    auto resolve = [&](const QString& path) {
+        QVariant v = JsonParser::resolvePlaceholderValue(response, path);
+        if (!v.isValid() || v.isNull()) v = JsonParser::resolvePlaceholderValue(normalized, path);
+        return v;
+    };
+
+    if (type.isEmpty() || policy.path.isEmpty()) {
+        // 未配置策略：沿用 MES 约定，header.result 为 NG/FAIL/false 视为失败
+        const QVariant result = resolve("header.result");
+        if (!result.isValid() || result.isNull()) return true;
+        const QString s = result.toString().trimmed();
+        return s.compare("NG", Qt::CaseInsensitive) != 0
+            && s.compare("FAIL", Qt::CaseInsensitive) != 0
+            && s.compare("false", Qt::CaseInsensitive) != 0;
+    }
 
-    timer->start(meta.timeoutMs);
+    const QVariant value = resolve(policy.path);
+    if (!value.isValid() || value.isNull()) return false;
+    const QString actual = value.toString().trimmed();
+
+    if (type == "equals") {
+        return actual.compare(policy.expected.toString().trimmed(), Qt::CaseInsensitive) == 0;
+    }
+    if (type == "regex") {
+        return QRegularExpression(policy.expected.toString()).match(actual).hasMatch();
+    }
+    if (type == "code_in") {
+        const QVariantList codes = policy.expected.type() == QVariant::List
+            ? policy.expected.toList() : QVariantList{ policy.expected };
+        for (const QVariant& code : codes) {
+            if (actual.compare(code.toString().trimmed(), Qt::CaseInsensitive) == 0) return true;
+        }
+        return false;
+    }
+
+    // 未知策略类型：保守处理，不缓存
+    return false;
 }
 
 /**
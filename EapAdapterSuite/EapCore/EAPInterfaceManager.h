@@ -5,11 +5,15 @@
 #include "eapcore_global.h"
 #include <QString>
 #include <QMap>
+#include <QHash>
 #include <QJsonObject>
 #include <QVariantMap>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QNetworkRequest>
 #include "EapInterfaceMeta.h"
+#include "EAPOutboundMessage.h"
+#include "EAPLatencySketch.h"
 #include "eap/EAPEnvelopeShim.h"
 #include "eap/EAPHeaderBinder.h"
 
@@ -42,6 +46,8 @@ public:
 
     QStringList getInterfaceKeys() const;
     EapInterfaceMeta& getInterface(const QString& key);
+    // 按 key 查找接口元数据（只读引用，不拷贝、不插入）；不存在返回 nullptr
+    const EapInterfaceMeta* findInterface(const QString& key) const;
 
     // 访问 HeaderBinder 以注册自定义 provider
     EAPHeaderBinder& headerBinder();
@@ -52,6 +58,11 @@ public:
     // 设置数据缓存
     void setDataCache(EAPDataCache* cache);
 
+    // 诊断：接口延迟分位数（p50/p99）与当前生效超时
+    EapLatencyStats latencyStats(const QString& interfaceKey) const;
+    // 当前生效超时（未启用自适应或样本不足时即 timeoutMs）
+    int effectiveTimeoutMs(const QString& interfaceKey) const;
+
 signals:
     void requestSent(const QString& key, const QJsonObject& payload);
     void responseReceived(const QString& key, const QJsonObject& response);
@@ -60,10 +71,31 @@ signals:
 
 private:
     void postWithRetry(const QString& interfaceKey, const EapInterfaceMeta& meta,
-        const QJsonObject& payload, int retriesLeft);
+        const EAPOutboundMessage& message, int retriesLeft, const QString& flightKey = QString());
+
+    // pull 接口响应缓存 + single-flight
+    QString responseCacheKey(const QString& interfaceKey, const EapInterfaceMeta& meta, const QJsonObject& payload) const;
+    bool serveFromCache(const QString& interfaceKey, const QString& flightKey);
+    void finishFlight(const QString& flightKey, const QString& interfaceKey, const EapInterfaceMeta& meta,
+        const QJsonObject& response, const QVariantMap& mapped, bool cacheable);
+    void failFlight(const QString& flightKey, const QString& interfaceKey, const QString& errorMsg);
+
+    // 按 method 发出一次 HTTP 请求
+    QNetworkReply* sendRequest(const QNetworkRequest& request, const QString& method, const QByteArray& body);
+    // 对冲：登记一次主请求并返回对冲延迟（0 表示不对冲）；尝试消耗一次对冲配额
+    int prepareHedge(const QString& interfaceKey, const EapInterfaceMeta& meta, int timeoutMs);
+    bool acquireHedgeToken(const QString& interfaceKey);
+
+    // 记录一次请求延迟样本 / 一次超时（超时单独计数，不进分位数）
+    void recordLatency(const QString& interfaceKey, qint64 elapsedMs);
+    void recordTimeout(const QString& interfaceKey);
+    // 按 AdaptiveTimeout 计算生效超时（调用方需持有 latencyMutex_）
+    int effectiveTimeoutLocked(const QString& interfaceKey, const EapInterfaceMeta& meta) const;
 
     // 检查响应是否需要重试（基于 RetryStrategy）
     bool shouldRetryBasedOnResponse(const EapInterfaceMeta& meta, const QVariantMap& parsedResponse) const;
+    // 按 successPolicy 判定响应是否业务成功（决定是否写入响应缓存）
+    bool isSuccessResponse(const EapInterfaceMeta& meta, const QJsonObject& response, const QJsonObject& normalized) const;
 
     void setInterfaces(const QMap<QString, EapInterfaceMeta>& list);
     void setBaseUrl(const QString& url);
@@ -89,4 +121,20 @@ private:
 
 
     mutable std::mutex cacheMutex_; // 保护数据缓存
+
+    // 每接口流式延迟统计（自适应超时 + 诊断）
+    QHash<QString, EAPLatencySketch> latencySketches_;
+    mutable std::mutex latencyMutex_; // 保护延迟统计
+
+    // 每接口对冲配额（按 max_ratio 累积，上限 1 次）
+    QHash<QString, double> hedgeTokens_;
+
+    // 响应缓存条目（cache_ttl_ms）
+    struct CachedResponse {
+        QJsonObject response;   // 原始响应
+        QVariantMap mapped;     // 映射后的结果
+        qint64 expiresAtMs = 0; // 过期时间（epoch ms）
+    };
+    QHash<QString, CachedResponse> responseCache_;  // 缓存键 -> 响应（仅管理器线程访问）
+    QHash<QString, int> inflightRequests_;          // 进行中的请求 -> 合并等待者数量
 };
\ No newline at end of file
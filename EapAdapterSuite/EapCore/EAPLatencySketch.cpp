@@ -0,0 +1,120 @@
+﻿#include "EAPLatencySketch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#pragma execution_character_set("utf-8")
+
+namespace {
+    // 桶的相对宽度：第 i 个桶覆盖 [1.05^i, 1.05^(i+1))
+    const double kGrowth = 1.05;
+    const double kLogGrowth = std::log(kGrowth);
+}
+
+EAPLatencySketch::EAPLatencySketch()
+    : total_(0)
+    , timeouts_(0)
+    , decayedAtMs_(0)
+{
+    buckets_.fill(0);
+    clock_.start();
+}
+
+/**
+ * @brief 计算延迟所在桶下标
+ * @param ms 延迟（毫秒）
+ * @return 桶下标（0 ~ kBucketCount-1）
+ */
+int EAPLatencySketch::bucketOf(qint64 ms)
+{
+    if (ms <= 1) return 0;
+    const int idx = static_cast<int>(std::log(static_cast<double>(ms)) / kLogGrowth);
+    return std::min(idx, kBucketCount - 1);
+}
+
+/**
+ * @brief 计算桶的上界（毫秒，向上取整）
+ * @param bucket 桶下标
+ * @return 上界毫秒数
+ */
+int EAPLatencySketch::upperBoundOf(int bucket)
+{
+    return static_cast<int>(std::ceil(std::pow(kGrowth, bucket + 1)));
+}
+
+/**
+ * @brief 所有计数减半 times 次
+ * @param times 减半次数
+ */
+void EAPLatencySketch::halve(int times) const
+{
+    if (times <= 0) return;
+    const int shift = std::min(times, 31);
+    total_ = 0;
+    for (quint32& c : buckets_) {
+        c >>= shift;
+        total_ += c;
+    }
+    timeouts_ >>= shift;
+}
+
+void EAPLatencySketch::decay() const
+{
+    const qint64 now = clock_.elapsed();
+    const qint64 periods = (now - decayedAtMs_) / kHalfLifeMs;
+    if (periods <= 0) return;
+    decayedAtMs_ += periods * kHalfLifeMs;
+    halve(static_cast<int>(std::min<qint64>(periods, 31)));
+}
+
+void EAPLatencySketch::record(qint64 ms)
+{
+    decay();
+    ++buckets_[bucketOf(ms)];
+    ++total_;
+
+    // 样本数超过窗口时立即减半，高频接口同样只反映近期分布
+    if (total_ > kWindow) halve(1);
+}
+
+void EAPLatencySketch::recordTimeout()
+{
+    decay();
+    ++timeouts_;
+}
+
+qint64 EAPLatencySketch::count() const
+{
+    decay();
+    return total_;
+}
+
+qint64 EAPLatencySketch::timeouts() const
+{
+    decay();
+    return timeouts_;
+}
+
+int EAPLatencySketch::percentile(double q) const
+{
+    decay();
+    if (total_ <= 0) return 0;
+    q = std::max(0.0, std::min(1.0, q));
+
+    // 目标排名（至少为 1），从低到高累加直到覆盖
+    const qint64 rank = std::max<qint64>(1, static_cast<qint64>(std::ceil(q * static_cast<double>(total_))));
+    qint64 seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) return upperBoundOf(i);
+    }
+    return upperBoundOf(kBucketCount - 1);
+}
+
+void EAPLatencySketch::reset()
+{
+    buckets_.fill(0);
+    total_ = 0;
+    timeouts_ = 0;
+    decayedAtMs_ = clock_.elapsed();
+}
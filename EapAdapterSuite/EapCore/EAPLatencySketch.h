@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include "eapcore_global.h"
+#include <QtGlobal>
+#include <QElapsedTimer>
+#include <array>
+
+/**
+ * @brief 单接口延迟统计快照（诊断用）
+ */
+struct EapLatencyStats {
+    qint64 samples = 0;          // 参与统计的样本数（已衰减）
+    qint64 timeouts = 0;         // 超时次数（已衰减，不计入分位数）
+    int p50Ms = 0;               // 中位延迟（ms）
+    int p99Ms = 0;               // 99 分位延迟（ms）
+    int effectiveTimeoutMs = 0;  // 当前生效的超时（ms）
+};
+
+/**
+ * @brief 流式延迟直方图（对数分桶，HDR 风格）
+ *
+ * 以相对误差约 5% 的对数桶记录 1 ms ~ 10 min 的延迟，常数内存、O(1) 记录。
+ * 按时间衰减：每经过一个半衰期所有桶计数减半（单调时钟，记录与查询时补算），
+ * 低频接口的旧样本不会长期停留；样本累计超过窗口时也立即减半，高频接口同样跟随近期分布。
+ * 超时只计次数、不进分位数（超时时长不是真实延迟，计入会使 k × p99 逐轮放大）。
+ * 非线程安全，由调用方加锁。
+ */
+class EAPCORE_EXPORT EAPLatencySketch
+{
+public:
+    EAPLatencySketch();
+
+    /**
+     * @brief 记录一次延迟样本
+     * @param ms 延迟（毫秒），小于 1 按 1 计，超过上限按上限计
+     */
+    void record(qint64 ms);
+
+    /**
+     * @brief 记录一次超时（单独计数，不影响分位数）
+     */
+    void recordTimeout();
+
+    /**
+     * @brief 估算分位数
+     * @param q 分位（0.0 ~ 1.0），如 0.99
+     * @return 分位延迟（毫秒，取所在桶上界）；无样本时返回 0
+     */
+    int percentile(double q) const;
+
+    // 当前样本数（已衰减）
+    qint64 count() const;
+
+    // 当前超时次数（已衰减）
+    qint64 timeouts() const;
+
+    // 清空全部样本
+    void reset();
+
+private:
+    static int bucketOf(qint64 ms);
+    static int upperBoundOf(int bucket);
+    // 按距上次衰减经过的半衰期数补算减半
+    void decay() const;
+    void halve(int times) const;
+
+    static constexpr int kBucketCount = 280;       // ln(600000) / ln(1.05) ≈ 273
+    static constexpr qint64 kWindow = 4096;        // 超过该样本数时衰减一半
+    static constexpr qint64 kHalfLifeMs = 60000;   // 时间衰减半衰期（ms）
+
+    // 查询时也需补算衰减，故为 mutable（调用方已加锁）
+    mutable std::array<quint32, kBucketCount> buckets_;
+    mutable qint64 total_;
+    mutable qint64 timeouts_;
+    mutable qint64 decayedAtMs_;   // 上次衰减的时刻（clock_ 计时）
+    QElapsedTimer clock_;
+};
@@ -151,8 +151,11 @@ bool EAPMessageLogger::insertRecord(const EAPMessageRecord& record)
     query.bindValue(":interface_description", record.interfaceDescription); // 接口描述
     query.bindValue(":remote_address", record.remoteAddress); // 远端地址，比如 "192.168.1.10:8080" 或 URL
     
-    QJsonDocument doc(record.payload);
-    query.bindValue(":payload", QString::fromUtf8(doc.toJson(QJsonDocument::Compact))); // 具体消息内容
+    // 具体消息内容：调用方已序列化的字节优先复用，避免大报文重复序列化
+    const QByteArray payloadBytes = record.payloadBytes.isEmpty()
+        ? QJsonDocument(record.payload).toJson(QJsonDocument::Compact)
+        : record.payloadBytes;
+    query.bindValue(":payload", QString::fromUtf8(payloadBytes));
     
     query.bindValue(":is_success", record.isSuccess ? 1 : 0); // 是否成功，通常 0 / 1，表示这条消息对应操作是否成功
     query.bindValue(":error_message", record.errorMessage); // 出错时的错误说明，比如异常文本、返回码解释等
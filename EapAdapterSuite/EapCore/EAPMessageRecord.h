@@ -4,6 +4,7 @@
 #include <QString>
 #include <QDateTime>
 #include <QJsonObject>
+#include <QByteArray>
 
 // EAP通信日志记录的消息记录结构
 struct EAPCORE_EXPORT EAPMessageRecord
@@ -22,6 +23,7 @@ struct EAPCORE_EXPORT EAPMessageRecord
     QString interfaceDescription; // 接口描述
     QString remoteAddress;        // 远端地址，比如 "192.168.1.10:8080" 或 URL
     QJsonObject payload;          // 具体消息内容
+    QByteArray payloadBytes;      // 可选：已序列化的紧凑 JSON（非空时入库直接复用，不再重复序列化 payload）
     bool isSuccess;               // 是否成功，通常 0 / 1，表示这条消息对应操作是否成功
     QString errorMessage;         // 出错时的错误说明，比如异常文本、返回码解释等
 
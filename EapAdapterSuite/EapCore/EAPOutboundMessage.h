@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include "JsonWriter.h"
+
+/**
+ * 出网报文（不可变）
+ * 构造时只序列化一次紧凑 JSON，网络发送、全部重试、消息日志与调试日志共享同一份字节，
+ * 拷贝仅增加引用计数，适合在 lambda 中按值捕获。
+ */
+class EAPOutboundMessage
+{
+public:
+    EAPOutboundMessage() = default;
+
+    explicit EAPOutboundMessage(const QJsonObject& payload)
+        : d(QSharedPointer<const Data>::create(payload)) {}
+
+    // 原始 JSON 对象（用于信号通知、响应映射等仍需 DOM 的场景）
+    const QJsonObject& payload() const { return d ? d->payload : empty().payload; }
+
+    // 紧凑 UTF-8 JSON 字节（只读共享）
+    const QByteArray& bytes() const { return d ? d->bytes : empty().bytes; }
+
+    bool isNull() const { return d.isNull(); }
+
+private:
+    struct Data {
+        explicit Data(const QJsonObject& obj = QJsonObject())
+            : payload(obj), bytes(JsonWriter::toJson(obj)) {}
+        const QJsonObject payload;  // 报文对象
+        const QByteArray bytes;     // 紧凑序列化结果
+    };
+
+    static const Data& empty() {
+        static const Data s_empty;
+        return s_empty;
+    }
+
+    QSharedPointer<const Data> d;
+};
@@ -1,64 +1,182 @@
 ﻿// EAPUploadQueueManager.cpp
 #include "EAPUploadQueueManager.h"
+#include "JsonWriter.h"
+#include "JsonBuilder.h"
 #include <QSqlError>
 #include <QSqlRecord>
+#include <QDateTime>
+#include <QSet>
 #include <QDebug>
+#include "LoggerInterface.h"
 
 EAPUploadQueueManager::EAPUploadQueueManager(EAPInterfaceManager* uploader, QObject* parent)
     : QObject(parent), uploader(uploader) {
     connect(&timer, &QTimer::timeout, this, &EAPUploadQueueManager::trySendNext);
+    lingerTimer.setSingleShot(true);
+    connect(&lingerTimer, &QTimer::timeout, this, &EAPUploadQueueManager::trySendNext);
+    connect(&compactTimer, &QTimer::timeout, this, [this]() { compact(); });
     connect(uploader, &EAPInterfaceManager::requestFailed, this, &EAPUploadQueueManager::onRequestFailed);
     connect(uploader, &EAPInterfaceManager::mappedResultReady, this, &EAPUploadQueueManager::onMappedResultReady);
-    initDb();
+    compactTimer.start(60000);
 }
 
 /**
  * @brief 尝试从队列中取出下一条任务并发送
- * @details 若当前仍有队列任务在发送中（currentId 不为空）则直接返回。
+ * @details 若当前仍有队列任务在发送中（currentIds 不为空）则直接返回。
  *          若成功从本地队列中取出任务，则把 JSON 负载转换为 QVariantMap，
  *          添加 "__fromQueue__" 标记，记录当前任务 id，并调用 uploader->post() 发送。
+ *          接口配置了批量上传（meta.batch）时交给 trySendBatch 合并同分组记录。
+ *          被补传过滤拦下的接口跳过，其记录留在队列中，不阻塞其它接口。
  */
 void EAPUploadQueueManager::trySendNext() {
-    if (!currentId.isEmpty()) return; // 等待上一个完成
-    QString id, key;
+    if (!currentIds.isEmpty()) return; // 等待上一个完成
+    QString id, key, groupKey;
+    qint64 createdMs = 0;
     QJsonObject payload;
-    if (!dequeue(id, key, payload)) return;
+    if (!dequeue(id, key, payload, &groupKey, &createdMs, blockedInterfaces())) return;
+
+    const EapInterfaceMeta* meta = uploader->findInterface(key);
+    if (meta && meta->batch.isEnabled()) {
+        trySendBatch(id, key, payload, groupKey, createdMs, meta->batch);
+        return;
+    }
 
     QVariantMap params = payload.toVariantMap();
     params["__fromQueue__"] = true;
-    currentId = id;
+    currentIds = QStringList{ id };
     uploader->post(key, params);
 }
 
+/**
+ * @brief 合并队首记录所在分组的排队记录，作为一次批量请求发送
+ * @param headId      队首记录 id
+ * @param interfaceKey 接口 key
+ * @param headPayload 队首记录的参数
+ * @param groupKey    队首记录的分组键
+ * @param createdMs   队首记录的入队时间（毫秒时间戳，旧记录为 0）
+ * @param policy      接口的批量上传策略
+ * @return true 表示已发送；false 表示记录不足上限且未到等待时间，已安排到期后重试
+ * @details 同分组记录按发送顺序最多取 maxItems 条，参数以 JsonBuilder::kBatchItemsKey 携带全部记录，
+ *          由 JsonBuilder 按 name[] 路径逐条追加；只有一条时按普通请求发送。
+ *          body 中只写一次的字段（非 name[] 追加的映射）与第一条记录不同的记录不能合并，
+ *          遇到第一条这样的记录即截止本批（其后的记录留待下一批），不再等待凑批。
+ */
+bool EAPUploadQueueManager::trySendBatch(const QString& headId, const QString& interfaceKey, const QJsonObject& headPayload,
+    const QString& groupKey, qint64 createdMs, const BatchPolicy& policy)
+{
+    const EapInterfaceMeta* meta = uploader->findInterface(interfaceKey);
+    QStringList ids;
+    QVariantList records;
+    bool closed = false; // 遇到不能合并的记录，本批已截止
+    {
+        QSqlQuery query(db);
+        query.prepare("SELECT id, json FROM upload_queue WHERE interface_key = ? AND group_key = ? AND dead = 0 ORDER BY seq ASC, id ASC LIMIT ?");
+        query.addBindValue(interfaceKey);
+        query.addBindValue(groupKey);
+        query.addBindValue(policy.maxItems);
+        if (query.exec()) {
+            while (query.next()) {
+                const QJsonDocument doc = QJsonDocument::fromJson(query.value(1).toByteArray());
+                if (!doc.isObject()) continue;
+                const QVariantMap rec = doc.object().toVariantMap();
+                if (!records.isEmpty() && meta && !JsonBuilder::batchCompatible(*meta, records.first().toMap(), rec)) {
+                    closed = true;
+                    break;
+                }
+                ids << query.value(0).toString();
+                records << rec;
+            }
+        }
+    }
+    if (ids.isEmpty()) { // 查询失败时退回单条发送
+        ids << headId;
+        records << headPayload.toVariantMap();
+    }
+
+    // 不足上限时最多等待 lingerMs（从队首记录入队算起）
+    const qint64 waited = QDateTime::currentMSecsSinceEpoch() - createdMs;
+    if (!closed && records.size() < policy.maxItems && createdMs > 0 && waited < policy.lingerMs) {
+        if (timer.isActive() && !lingerTimer.isActive())
+            lingerTimer.start(static_cast<int>(policy.lingerMs - waited));
+        return false;
+    }
+
+    QVariantMap params = records.first().toMap();
+    if (records.size() > 1)
+        params[JsonBuilder::kBatchItemsKey] = records;
+    params["__fromQueue__"] = true;
+
+    currentIds = ids;
+    currentItems.clear();
+    currentKey = interfaceKey;
+    currentFailedKey = policy.failedItemsKey;
+    if (!policy.itemKey.isEmpty()) {
+        for (int i = 0; i < ids.size(); ++i)
+            currentItems.insert(ids.at(i), records.at(i).toMap().value(policy.itemKey).toString());
+    }
+    uploader->post(interfaceKey, params);
+    return true;
+}
+
 /**
  * @brief 处理请求成功（结果已就绪）的回调
  * @param key     完成请求所对应的接口 key
- * @param result  已映射的结果数据（此处未使用）
- * @details 若 currentId 不为空，说明这是当前队列任务的成功回调，
- *          则从本地队列数据库中删除该任务并清空 currentId，
+ * @param result  已映射的结果数据（批量请求时读取失败记录列表）
+ * @details 若 currentIds 不为空，说明这是当前队列任务的成功回调，
+ *          则从本地队列数据库中删除该任务并清空 currentIds，
  *          以便后续可以继续发送下一条队列任务。
+ *          批量请求若配置了 item_key / failed_items_key，响应中列出的失败记录移到队尾重试，其余删除；
+ *          同一记录被拒绝达到 batch.max_attempts 次后转入死信，不再发送。
  */
-void EAPUploadQueueManager::onMappedResultReady(const QString& key, const QVariantMap&) {
-    if (!currentId.isEmpty()) {
-        remove(currentId);
-        currentId.clear();
+void EAPUploadQueueManager::onMappedResultReady(const QString& key, const QVariantMap& result) {
+    if (currentIds.isEmpty()) return;
+
+    if (currentItems.isEmpty()) {
+        for (const QString& id : currentIds)
+            remove(id);
+        currentIds.clear();
+        return;
+    }
+
+    // 批量请求：只处理本批次接口的结果；响应列出的失败记录移到队尾重试，其余删除
+    if (key != currentKey) return;
+    const EapInterfaceMeta* meta = uploader->findInterface(currentKey);
+    const int maxAttempts = meta ? meta->batch.maxAttempts : BatchPolicy().maxAttempts;
+    QSet<QString> failed;
+    if (!currentFailedKey.isEmpty()) {
+        const QVariant v = result.value(currentFailedKey);
+        const QStringList list = (v.type() == QVariant::String)
+            ? v.toString().split(',', QString::SkipEmptyParts) : v.toStringList();
+        for (const QString& item : list)
+            failed.insert(item.trimmed());
+    }
+    for (const QString& id : currentIds) {
+        if (failed.contains(currentItems.value(id)))
+            requeue(id, maxAttempts);
+        else
+            remove(id);
     }
+    currentIds.clear();
+    currentItems.clear();
+    currentKey.clear();
 }
 
 /**
  * @brief 处理请求失败的回调
  * @param key        失败请求所对应的接口 key
  * @param errorDesc  失败原因描述（此处未使用）
- * @details 若 currentId 不为空，说明失败的是队列中的任务，仅清空 currentId，
+ * @details 若 currentIds 不为空，说明失败的是队列中的任务（批量时为整批），仅清空 currentIds，
  *          保留数据库记录以便之后由定时器再次重试发送；
- *          若 currentId 为空，则认为失败的是外部直接提交的请求，
+ *          若 currentIds 为空，则认为失败的是外部直接提交的请求，
  *          若接口 key 为 "upload_panel_data"，则将其写入本地上传队列，
  *          以便后续自动重试（实际使用中应由调用方保存并传入原始参数）。
  */
 void EAPUploadQueueManager::onRequestFailed(const QString& key, const QString&) {
-    if (!currentId.isEmpty()) {
+    if (!currentIds.isEmpty()) {
         // 当前是队列中的任务，保留等待下次重试
-        currentId.clear();
+        currentIds.clear();
+        currentItems.clear();
+        currentKey.clear();
         return;
     }
     // 否则是外部提交失败，写入队列
@@ -71,6 +189,9 @@ void EAPUploadQueueManager::onRequestFailed(const QString& key, const QString&)
  * @details 创建名为 "upload_queue" 的数据库连接并打开 "upload_queue.db" 文件。
  *          若 upload_queue 表不存在则创建，该表用于存储待上传任务的接口 key
  *          及其 JSON 负载，实现跨进程/重启的持久化队列。
+ *          id 为入队顺序（不再改变，用于取代判断）；seq 为发送顺序（重新排队时移到队尾）；
+ *          attempts 为被逐项拒绝的次数，dead = 1 表示已转入死信、不再发送。
+ *          由 ensureDb 在首次使用时调用。
  */
 void EAPUploadQueueManager::initDb() {
     db = QSqlDatabase::addDatabase("QSQLITE", "upload_queue");
@@ -82,16 +203,122 @@ void EAPUploadQueueManager::initDb() {
     query.exec("CREATE TABLE IF NOT EXISTS upload_queue ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "interface_key TEXT NOT NULL,"
-        "json TEXT NOT NULL"
+        "json TEXT NOT NULL,"
+        "group_key TEXT NOT NULL DEFAULT '',"
+        "created_ms INTEGER NOT NULL DEFAULT 0,"
+        "supersede_key TEXT NOT NULL DEFAULT '',"
+        "seq INTEGER NOT NULL DEFAULT 0,"
+        "attempts INTEGER NOT NULL DEFAULT 0,"
+        "dead INTEGER NOT NULL DEFAULT 0"
         ")");
+    // 旧库补列（已存在时执行失败，忽略）
+    query.exec("ALTER TABLE upload_queue ADD COLUMN group_key TEXT NOT NULL DEFAULT ''");
+    query.exec("ALTER TABLE upload_queue ADD COLUMN created_ms INTEGER NOT NULL DEFAULT 0");
+    query.exec("ALTER TABLE upload_queue ADD COLUMN supersede_key TEXT NOT NULL DEFAULT ''");
+    query.exec("ALTER TABLE upload_queue ADD COLUMN seq INTEGER NOT NULL DEFAULT 0");
+    query.exec("ALTER TABLE upload_queue ADD COLUMN attempts INTEGER NOT NULL DEFAULT 0");
+    query.exec("ALTER TABLE upload_queue ADD COLUMN dead INTEGER NOT NULL DEFAULT 0");
+    // 旧记录的发送顺序沿用原 id 顺序
+    query.exec("UPDATE upload_queue SET seq = id WHERE seq = 0");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_upload_queue_group_seq ON upload_queue (interface_key, group_key, dead, seq)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_upload_queue_supersede ON upload_queue (interface_key, supersede_key, id)");
+    query.exec("CREATE INDEX IF NOT EXISTS idx_upload_queue_order ON upload_queue (dead, seq)");
+}
+
+bool EAPUploadQueueManager::ensureDb() {
+    if (!dbInitialized) {
+        dbInitialized = true;
+        initDb();
+    }
+    return db.isOpen();
 }
 
+/**
+ * @brief 开始补传队列
+ * @details 先压缩一次，重新上线后补传的条数只与离线期间的不同状态数有关，而与离线时长无关。
+ */
 void EAPUploadQueueManager::start() {
+    compact();
     timer.start(10000); // 每10秒检查一次
 }
 
+void EAPUploadQueueManager::setSendFilter(std::function<bool(const QString& interfaceKey)> filter) {
+    sendFilter = std::move(filter);
+}
+
+/**
+ * @brief 列出队列中当前被补传过滤拦下的接口
+ * @return 接口 key 列表；未设置过滤时为空
+ */
+QStringList EAPUploadQueueManager::blockedInterfaces() {
+    QStringList blocked;
+    if (!sendFilter || !ensureDb()) return blocked;
+    QSqlQuery query(db);
+    if (!query.exec("SELECT DISTINCT interface_key FROM upload_queue WHERE dead = 0")) return blocked;
+    while (query.next()) {
+        const QString key = query.value(0).toString();
+        if (!sendFilter(key)) blocked << key;
+    }
+    return blocked;
+}
+
+void EAPUploadQueueManager::setCompactInterval(int ms) {
+    if (ms > 0)
+        compactTimer.start(ms);
+    else
+        compactTimer.stop();
+}
+
+/**
+ * @brief 按各接口的 queue_policy 压缩队列
+ * @return 删除的记录条数
+ * @details latest_only_per_key：同一接口同一取代键只保留 id 最大（最晚入队）的一条；
+ *          id 在重新排队时不变，被拒绝后重试的旧数据不会取代之后入队的新数据；
+ *          drop_when_stale_after_ms：删除入队时间早于时限的记录（旧库 created_ms 为 0 的记录不处理）。
+ *          正在发送中的记录不删除，其结果仍按原流程确认。
+ */
+int EAPUploadQueueManager::compact() {
+    if (!ensureDb()) return 0;
+    // 正在发送的记录以常量排除（id 来自本表主键，均为整数）
+    QStringList inflight;
+    for (const QString& id : currentIds)
+        inflight << QString::number(id.toLongLong());
+    const QString excludeInflight = inflight.isEmpty() ? QString()
+        : QString(" AND id NOT IN (%1)").arg(inflight.join(','));
+
+    int removed = 0;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const QString& key : uploader->getInterfaceKeys()) {
+        const EapInterfaceMeta* meta = uploader->findInterface(key);
+        if (!meta || !meta->queuePolicy.needsCompaction()) continue;
+        const QueuePolicy& policy = meta->queuePolicy;
+
+        if (policy.mode == QueuePolicy::Mode::LatestOnlyPerKey) {
+            QSqlQuery query(db);
+            query.prepare("DELETE FROM upload_queue WHERE interface_key = ? AND supersede_key <> ''"
+                " AND id < (SELECT MAX(q.id) FROM upload_queue q"
+                " WHERE q.interface_key = upload_queue.interface_key AND q.supersede_key = upload_queue.supersede_key)"
+                + excludeInflight);
+            query.addBindValue(key);
+            if (query.exec()) removed += query.numRowsAffected();
+        }
+        if (policy.dropWhenStaleAfterMs > 0) {
+            QSqlQuery query(db);
+            query.prepare("DELETE FROM upload_queue WHERE interface_key = ? AND created_ms > 0 AND created_ms < ?"
+                + excludeInflight);
+            query.addBindValue(key);
+            query.addBindValue(now - policy.dropWhenStaleAfterMs);
+            if (query.exec()) removed += query.numRowsAffected();
+        }
+    }
+    if (removed > 0)
+        LOG_TYPE_INFO("MES", "upload queue compacted: {} superseded/stale records removed", removed);
+    return removed;
+}
+
 void EAPUploadQueueManager::stop() {
     timer.stop();
+    lingerTimer.stop();
 }
 
 /**
@@ -106,6 +333,43 @@ void EAPUploadQueueManager::submit(const QString& interfaceKey, const QVariantMa
     if (fromQueue) return; // 队列中的请求失败不再重复提交
     QJsonObject payload = QJsonObject::fromVariantMap(params);
     enqueue(interfaceKey, payload);
+
+    // 批量上传：同分组凑满上限立即尝试发送，否则等待 lingerMs 后发送
+    const EapInterfaceMeta* meta = uploader->findInterface(interfaceKey);
+    if (!timer.isActive() || !meta || !meta->batch.isEnabled()) return;
+    const QString groupKey = meta->batch.groupKey.isEmpty() ? QString() : params.value(meta->batch.groupKey).toString();
+    if (countGroup(interfaceKey, groupKey) >= meta->batch.maxItems)
+        QTimer::singleShot(0, this, &EAPUploadQueueManager::trySendNext);
+    else if (!lingerTimer.isActive())
+        lingerTimer.start(qMax(0, meta->batch.lingerMs));
+}
+
+/**
+ * @brief 计算记录的取代键
+ * @return latest_only_per_key 接口返回 key_fields 各字段值的拼接（无 key_fields 时为 "*"）；其它接口返回空串
+ */
+QString EAPUploadQueueManager::supersedeKey(const EapInterfaceMeta* meta, const QJsonObject& payload) {
+    if (!meta || meta->queuePolicy.mode != QueuePolicy::Mode::LatestOnlyPerKey)
+        return QString();
+    if (meta->queuePolicy.keyFields.isEmpty())
+        return QStringLiteral("*");
+    QStringList parts;
+    for (const QString& field : meta->queuePolicy.keyFields)
+        parts << payload.value(field).toVariant().toString();
+    return parts.join(QChar(0x1F));
+}
+
+/**
+ * @brief 统计某接口某分组的排队记录数
+ */
+int EAPUploadQueueManager::countGroup(const QString& interfaceKey, const QString& groupKey) {
+    if (!ensureDb()) return 0;
+    QSqlQuery query(db);
+    query.prepare("SELECT COUNT(*) FROM upload_queue WHERE interface_key = ? AND group_key = ? AND dead = 0");
+    query.addBindValue(interfaceKey);
+    query.addBindValue(groupKey);
+    if (!query.exec() || !query.next()) return 0;
+    return query.value(0).toInt();
 }
 
 /**
@@ -116,33 +380,60 @@ void EAPUploadQueueManager::submit(const QString& interfaceKey, const QVariantMa
  *          将接口名和压缩后的 JSON 字符串写入表中，以实现上传任务的持久化存储。
  */
 void EAPUploadQueueManager::enqueue(const QString& interfaceKey, const QJsonObject& payload) {
+    // 批量上传接口记录分组键（如 lot_id），便于按分组合并
+    QString groupKey;
+    const EapInterfaceMeta* meta = uploader->findInterface(interfaceKey);
+    if (meta && meta->batch.isEnabled() && !meta->batch.groupKey.isEmpty())
+        groupKey = payload.value(meta->batch.groupKey).toVariant().toString();
+
+    if (!ensureDb()) return;
     QSqlQuery query(db);
-    query.prepare("INSERT INTO upload_queue (interface_key, json) VALUES (?, ?)");
+    query.prepare("INSERT INTO upload_queue (interface_key, json, group_key, created_ms, supersede_key, seq)"
+        " VALUES (?, ?, ?, ?, ?, (SELECT IFNULL(MAX(seq), 0) + 1 FROM upload_queue))");
     query.addBindValue(interfaceKey);
-	QString jason = QJsonDocument(payload).toJson(QJsonDocument::Compact);  // 压缩 JSON
+	QString jason = QString::fromUtf8(JsonWriter::toJson(payload));  // 压缩 JSON
     query.addBindValue(jason);
+    query.addBindValue(groupKey);
+    query.addBindValue(QDateTime::currentMSecsSinceEpoch());
+    query.addBindValue(supersedeKey(meta, payload));
     if (!query.exec()) {
     }
 }
 
 /**
  * @brief 从本地上传队列表中取出一条任务（只读取不删除）
- * @param id           [out] 任务在表中的主键 id（按 id 升序取最早一条）
+ * @param id           [out] 任务在表中的主键 id（按发送顺序 seq 取最早一条，死信记录除外）
  * @param interfaceKey [out] 接口标识，用于后续调用对应接口
  * @param payload      [out] 解析后的请求数据（JSON 对象）
+ * @param groupKey     [out] 可选，记录的分组键
+ * @param createdMs    [out] 可选，记录的入队时间（毫秒时间戳，旧记录为 0）
+ * @param skipKeys     跳过这些接口的记录（补传过滤拦下的接口）
  * @return true 表示成功取到一条有效记录并成功解析 JSON，false 表示队列为空、
  *         查询失败或 JSON 解析错误。
  * @details 该函数只负责读取队列头部任务，并不会删除记录；实际删除由 remove()
  *          在任务成功上传后完成。若队列中存储的 json 无法解析为对象，将返回 false。
  */
-bool EAPUploadQueueManager::dequeue(QString& id, QString& interfaceKey, QJsonObject& payload) {
+bool EAPUploadQueueManager::dequeue(QString& id, QString& interfaceKey, QJsonObject& payload,
+    QString* groupKey, qint64* createdMs, const QStringList& skipKeys) {
+    if (!ensureDb()) return false;
+    QStringList placeholders;
+    for (int i = 0; i < skipKeys.size(); ++i)
+        placeholders << QStringLiteral("?");
+    const QString skip = skipKeys.isEmpty() ? QString()
+        : QString(" AND interface_key NOT IN (%1)").arg(placeholders.join(','));
     QSqlQuery query(db);
-    if (!query.exec("SELECT id, interface_key, json FROM upload_queue ORDER BY id ASC LIMIT 1"))
+    query.prepare("SELECT id, interface_key, json, group_key, created_ms FROM upload_queue WHERE dead = 0"
+        + skip + " ORDER BY seq ASC, id ASC LIMIT 1");
+    for (const QString& key : skipKeys)
+        query.addBindValue(key);
+    if (!query.exec())
         return false;
     if (!query.next()) return false;
 
     id = query.value(0).toString();
     interfaceKey = query.value(1).toString();
+    if (groupKey) *groupKey = query.value(3).toString();
+    if (createdMs) *createdMs = query.value(4).toLongLong();
 
     QJsonParseError err;
     QJsonDocument doc = QJsonDocument::fromJson(query.value(2).toByteArray(), &err);
@@ -164,4 +455,31 @@ void EAPUploadQueueManager::remove(const QString& id) {
     query.exec();
 }
 
+/**
+ * @brief 把指定任务移到队尾（批量请求中被 MES 拒绝的记录重新排队）
+ * @param id          任务在表中的主键 id
+ * @param maxAttempts 被拒绝次数上限（> 0 时达到后转入死信）
+ * @details 只改发送顺序 seq 与尝试次数；id（入队顺序）与 created_ms（入队时间）保持不变，
+ *          取代与过期判断仍按记录最初入队计算。
+ */
+void EAPUploadQueueManager::requeue(const QString& id, int maxAttempts) {
+    QSqlQuery query(db);
+    query.prepare("UPDATE upload_queue SET seq = (SELECT IFNULL(MAX(seq), 0) + 1 FROM upload_queue),"
+        " attempts = attempts + 1,"
+        " dead = CASE WHEN ? > 0 AND attempts + 1 >= ? THEN 1 ELSE 0 END"
+        " WHERE id = ?");
+    query.addBindValue(maxAttempts);
+    query.addBindValue(maxAttempts);
+    query.addBindValue(id);
+    if (!query.exec()) return;
+
+    QSqlQuery check(db);
+    check.prepare("SELECT interface_key, attempts FROM upload_queue WHERE id = ? AND dead = 1");
+    check.addBindValue(id);
+    if (check.exec() && check.next()) {
+        LOG_TYPE_ERROR("MES", "upload queue record {} ({}) dead-lettered after {} rejected attempts",
+            id.toStdString(), check.value(0).toString().toStdString(), check.value(1).toInt());
+    }
+}
+
 
@@ -8,6 +8,9 @@
 #include <QSqlQuery>
 #include <QJsonObject>
 #include <QJsonDocument>
+#include <QHash>
+#include <QStringList>
+#include <functional>
 #include "EAPInterfaceManager.h"
 
 class EAPCORE_EXPORT EAPUploadQueueManager : public QObject {
@@ -18,6 +21,13 @@ public:
     void start();
     void stop();
 
+    // 按接口 queue_policy 压缩队列（删除被取代 / 过期的记录），返回删除条数
+    int compact();
+    // 后台压缩周期（ms），默认 60 秒；<= 0 表示只在 start() 时压缩
+    void setCompactInterval(int ms);
+    // 补传过滤：返回 false 的接口记录暂不发送、保留在队列中（如半自动模式下未允许的接口），不影响其它接口的记录
+    void setSendFilter(std::function<bool(const QString& interfaceKey)> filter);
+
 private slots:
     void trySendNext();
     void onRequestFailed(const QString& key, const QString& error);
@@ -25,12 +35,35 @@ private slots:
 
 private:
     void initDb();
+    // 首次使用时打开队列库（启动时不做磁盘 IO）；打开失败返回 false
+    bool ensureDb();
     void enqueue(const QString& interfaceKey, const QJsonObject& payload);
-    bool dequeue(QString& id, QString& interfaceKey, QJsonObject& payload);
+    bool dequeue(QString& id, QString& interfaceKey, QJsonObject& payload,
+        QString* groupKey = nullptr, qint64* createdMs = nullptr, const QStringList& skipKeys = QStringList());
+    // 队列中被补传过滤拦下的接口
+    QStringList blockedInterfaces();
     void remove(const QString& id);
+    // 被逐项拒绝的记录移到队尾并累计尝试次数，达到 maxAttempts（> 0）时转入死信
+    void requeue(const QString& id, int maxAttempts);
+
+    // 批量上传（meta.batch）：合并同分组的排队记录为一次请求；返回 false 表示仍在等待凑批
+    bool trySendBatch(const QString& headId, const QString& interfaceKey, const QJsonObject& headPayload,
+        const QString& groupKey, qint64 createdMs, const BatchPolicy& policy);
+    int countGroup(const QString& interfaceKey, const QString& groupKey);
+    // latest_only_per_key 接口的取代键（不参与取代时为空）
+    static QString supersedeKey(const EapInterfaceMeta* meta, const QJsonObject& payload);
 
     QTimer timer; 
+    QTimer lingerTimer; // 批量凑批等待到期后尝试发送
+    QTimer compactTimer; // 后台压缩（离线期间同样运行）
     QSqlDatabase db;
+    bool dbInitialized = false; // 已尝试打开队列库
     EAPInterfaceManager* uploader;
-    QString currentId; // 当前发送中的记录ID
+    QStringList currentIds; // 当前发送中的记录ID（批量发送时为多条）
+    std::function<bool(const QString&)> sendFilter; // 补传过滤（为空表示全部补传）
+
+    // 当前批量请求的逐项确认信息（单条发送时为空）
+    QString currentKey;                   // 批量请求的接口 key
+    QString currentFailedKey;             // 响应中列出失败记录标识的本地字段
+    QHash<QString, QString> currentItems; // 记录ID -> 记录标识（item_key）
 };
@@ -11,9 +11,13 @@
 #include <thread>
 #include <future>
 #include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <algorithm>
 
 #include "VendorConfigLoader.h"
 #include "JsonBuilder.h"
+#include "JsonWriter.h"
 #include "EAPMessageLogger.h"
 #include "EAPMessageRecord.h"
 #include "EAPDataCache.h"
@@ -24,14 +28,53 @@
 #include "third_party/cpp-httplib/httplib.h"
 
 namespace {
-    inline std::string toStdString(const QByteArray& ba) { // 把 QByteArray 转成 std::string
-        return std::string(ba.constData(), static_cast<size_t>(ba.size()));
+    // 每个 HTTP 工作线程复用一个写出缓冲区
+    JsonWriter& responseWriter() {
+        thread_local JsonWriter writer(4096);
+        return writer;
     }
-    inline std::string jsonString(const QJsonObject& obj) { // 把 QJsonObject 包装成 QJsonDocument
-        return toStdString(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    // 把 QJsonObject 直接写成紧凑 JSON 作为响应体，返回写出的缓冲区（供日志使用，下次写入前有效）
+    inline const QByteArray& setJsonContent(httplib::Response& res, const QJsonObject& obj) {
+        JsonWriter& writer = responseWriter();
+        writer.clear();
+        writer.write(obj);
+        res.set_content(writer.data(), static_cast<size_t>(writer.size()), "application/json");
+        return writer.buffer();
     }
 } // namespace
 
+// 异步响应句柄的共享状态：HTTP 线程等待，业务线程 finish()
+struct EAPResponseHandle::State {
+    enum class Phase { Pending, Finished, Expired, Cancelled };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    Phase phase = Phase::Pending;
+    QJsonObject response;
+
+    // 仅在 Pending 时切换到目标阶段，返回是否切换成功
+    bool settle(Phase to, const QJsonObject& resp = QJsonObject()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (phase != Phase::Pending) return false;
+            phase = to;
+            response = resp;
+        }
+        cv.notify_all();
+        return true;
+    }
+};
+
+bool EAPResponseHandle::finish(const QJsonObject& response) const {
+    return s_ && s_->settle(State::Phase::Finished, response);
+}
+
+bool EAPResponseHandle::isDone() const {
+    if (!s_) return true;
+    std::lock_guard<std::mutex> lock(s_->mutex);
+    return s_->phase != State::Phase::Pending;
+}
+
 struct EAPWebService::Impl {
     // 1.接口配置
     QMap<QString, EapInterfaceMeta> interfaces; // 描述每个 EAP 接口的元数据（地址、body 映射等）
@@ -65,6 +108,7 @@ struct EAPWebService::Impl {
     // 5.回调与超时
     std::function<QJsonObject(const QString&, const QJsonObject&, const QVariantMap&)> rawResponder; // 原始 JSON 回调，比如直接处理 MES 原始 body
     std::function<QVariantMap(const QString&, const QJsonObject&, const QVariantMap&)> mappedResponder; // 映射后的业务回调，可能会用 JsonBuilder 之类先把 body 解析成 QVariantMap 再给业务层
+    AsyncResponder asyncResponder; // 异步回调：接管的请求通过 EAPResponseHandle 稍后完成
     int responderTimeoutMs = 0; // 回调执行超时时间，配合下面的 runWithTimeout 使用
 
     // 6.索引
@@ -84,6 +128,10 @@ struct EAPWebService::Impl {
     EAPDataCache* dataCache_ = nullptr; // 数据缓存组件
     mutable std::mutex cacheMutex_; // 保护数据缓存
 
+    // 10.等待中的异步响应（stop() 时统一取消，避免 HTTP 线程等到超时）
+    std::vector<std::shared_ptr<EAPResponseHandle::State>> pendingResponses;
+    std::mutex pendingMutex_;
+
     // 不区分大小写的前缀判断
     static bool startsWithInsensitive(const std::string& s, const char* prefix) {
         size_t n = strlen(prefix);
@@ -156,6 +204,32 @@ struct EAPWebService::Impl {
             allowListL.insert(f.toLower());
     }
 
+    // 等待异步响应完成；timeoutMs <= 0 时一直等到完成或服务停止。返回最终阶段，完成时写出响应
+    EAPResponseHandle::State::Phase waitResponse(const std::shared_ptr<EAPResponseHandle::State>& s,
+        int timeoutMs, QJsonObject& out) {
+        using Phase = EAPResponseHandle::State::Phase;
+        {
+            std::unique_lock<std::mutex> lock(s->mutex);
+            auto done = [&s]() { return s->phase != Phase::Pending; };
+            if (timeoutMs > 0)
+                s->cv.wait_for(lock, std::chrono::milliseconds(timeoutMs), done);
+            else
+                s->cv.wait(lock, done);
+        }
+        s->settle(Phase::Expired); // 仍未完成则标记超时，之后的 finish() 不再生效
+
+        {
+            std::lock_guard<std::mutex> lock(pendingMutex_);
+            pendingResponses.erase(std::remove(pendingResponses.begin(), pendingResponses.end(), s),
+                pendingResponses.end());
+        }
+
+        std::lock_guard<std::mutex> lock(s->mutex);
+        if (s->phase == Phase::Finished)
+            out = s->response;
+        return s->phase;
+    }
+
     // 在限定时间内执行一个函数 f，如果按时执行完就返回结果
     template <typename T, typename Func>
     std::pair<bool, T> runWithTimeout(Func f, int timeoutMs) {
@@ -343,9 +417,24 @@ void EAPWebService::setMappedResponder(std::function<QVariantMap(const QString&,
     d->mappedResponder = std::move(cb);
 }
 
+/**
+ * @brief 注册“异步模式”的业务处理回调
+ * @param cb 回调函数，返回 true 表示接管请求并稍后通过 EAPResponseHandle::finish() 响应，
+ *           返回 false 表示不处理，继续交给 rawResponder / mappedResponder
+ *
+ * 回调在 HTTP 线程中调用，应尽快返回（例如把工作投递到 GUI 线程后立即返回 true）。
+ * cpp-httplib 按连接同步处理，等待完成期间该 HTTP 工作线程阻塞在句柄的条件变量上（不再另起线程），
+ * 因此异步模式只是给出等待上限，并不释放工作线程。
+ * 超过 setResponderTimeoutMs()（未设置时为该接口的 timeoutMs，再缺省为 kDefaultAsyncTimeoutMs）仍未完成则返回 504。
+ */
+void EAPWebService::setAsyncResponder(AsyncResponder cb) {
+    std::lock_guard<std::mutex> lock(d->callbackMutex_);
+    d->asyncResponder = std::move(cb);
+}
+
 /**
  * @brief 设置业务回调执行的超时时间
- * @param timeoutMs 超时时间（毫秒）。<=0 表示不启用超时控制
+ * @param timeoutMs 超时时间（毫秒）。<=0 表示同步回调不启用超时控制，异步回调按接口 timeoutMs（缺省 kDefaultAsyncTimeoutMs）等待
  */
 void EAPWebService::setResponderTimeoutMs(int timeoutMs) {
     std::lock_guard<std::mutex> lock(d->callbackMutex_);
@@ -407,6 +496,13 @@ void EAPWebService::setDataCache(EAPDataCache* cache)
  */
 void EAPWebService::stop() {
     if (!d->server) return;
+    {
+        // 先取消等待中的异步响应，HTTP 线程才能尽快返回
+        std::lock_guard<std::mutex> lock(d->pendingMutex_);
+        for (const auto& s : d->pendingResponses)
+            s->settle(EAPResponseHandle::State::Phase::Cancelled);
+        d->pendingResponses.clear();
+    }
     d->server->stop();
     if (d->worker.joinable()) d->worker.join();
     d->server.reset();
@@ -467,15 +563,15 @@ bool EAPWebService::start(quint16 port, const QString& host) {
             }
 
             QJsonParseError jerr{};
-            const QByteArray bytes(req.body.data(), static_cast<int>(req.body.size()));
+            // 直接引用 req.body（请求处理期间有效），不再拷贝一份
+            const QByteArray bytes = QByteArray::fromRawData(req.body.data(), static_cast<int>(req.body.size()));
             const QJsonDocument doc = QJsonDocument::fromJson(bytes, &jerr);
             if (jerr.error != QJsonParseError::NoError || !doc.isObject()) {
-                const std::string body = jsonString(QJsonObject{
+                res.status = 400;
+                setJsonContent(res, QJsonObject{
                     {"code", 400},
                     {"message", QString("Invalid JSON: %1").arg(jerr.errorString())}
                     });
-                res.status = 400;
-                res.set_content(body, "application/json");
                 QMetaObject::invokeMethod(this, [this, functionName, remote, jerr]() {
                     emit requestRejected(functionName, 400, QString("Invalid JSON: %1").arg(jerr.errorString()), remote);
                     }, Qt::QueuedConnection);
@@ -548,8 +644,7 @@ bool EAPWebService::start(quint16 port, const QString& host) {
             const bool needStrict = (strictHeadFunctionMatch && envelopeCfg.strictMatch);
             if (!EAPEnvelope::strictFunctionMatchOk(normalized, functionName, needStrict, &reason)) {
                 res.status = 400;
-                const std::string body = jsonString(QJsonObject{ {"code", 400}, {"message", reason} });
-                res.set_content(body, "application/json");
+                setJsonContent(res, QJsonObject{ {"code", 400}, {"message", reason} });
                 QMetaObject::invokeMethod(this, [this, functionName, remote, reason]() {
                     emit requestRejected(functionName, 400, reason, remote);
                     }, Qt::QueuedConnection);
@@ -581,7 +676,10 @@ bool EAPWebService::start(quint16 port, const QString& host) {
                     }
                     }, Qt::QueuedConnection);
             }
-            LOG_TYPE_DEBUG("MES", "webservice receive  [{}]", QJsonDocument(reqObj).toJson().toStdString().c_str());
+            // 直接记录原始请求体，仅在 debug 级别开启时输出（不再重新序列化）
+            if (LOG_TYPE_DEBUG_ENABLED("MES")) {
+                LOG_TYPE_DEBUG("MES", "webservice receive  [{}]", req.body.c_str());
+            }
             QMetaObject::invokeMethod(this, [this, functionName, reqObj, headers, remote]() {
                 emit requestReceived(functionName, reqObj, headers, remote);
                 }, Qt::QueuedConnection);
@@ -700,10 +798,9 @@ bool EAPWebService::start(quint16 port, const QString& host) {
                             }
 
                             if (!keys.isEmpty()) {
-                                // 预先把要保存的数据转换一次（避免在 lambda 中重复转换）
-                                QVariantMap payloadMap = normalized.toVariantMap();
-                                // 捕获 functionNameFromConfig、keys、payloadMap（通过拷贝或 move）
-                                QMetaObject::invokeMethod(this, [this, functionNameFromConfig, keys, payloadMap]() mutable {
+                                // 在 HTTP 线程上预先把要保存的数据转换一次，不占用接收线程（主线程）的时间
+                                const QVariantMap payloadMap = normalized.toVariantMap();
+                                QMetaObject::invokeMethod(this, [this, functionNameFromConfig, keys, payloadMap]() {
                                     std::lock_guard<std::mutex> lock(d->cacheMutex_);
                                     if (!d->dataCache_ || !d->dataCache_->isInitialized()) return;
                                     for (const QString& key : keys) {
@@ -738,22 +835,91 @@ bool EAPWebService::start(quint16 port, const QString& host) {
                 return head;
                 };
 
+            // 业务返回的 JSON（raw / async 共用）：空 -> 默认 ACK；否则包成响应外壳
+            auto makeRawResponse = [&](const QJsonObject& outObj) {
+                if (outObj.isEmpty()) {
+                    if (hadEnvelope) {
+                        return EAPEnvelope::makeResponseEnvelope(QJsonObject(), reqObj, envelopeCfg, true,
+                            makeDefaultHeadOK());
+                    }
+                    return QJsonObject{ {"code", 0}, {"message", "OK"} };
+                }
+                return EAPEnvelope::makeResponseEnvelope(outObj, reqObj, envelopeCfg, hadEnvelope,
+                    makeDefaultHeadOK());
+                };
+
             int status = 200;
             QJsonObject respJson;
 
             // === P0: 线程安全 - 获取回调副本 ===
             std::function<QJsonObject(const QString&, const QJsonObject&, const QVariantMap&)> rawResponderCopy;
             std::function<QVariantMap(const QString&, const QJsonObject&, const QVariantMap&)> mappedResponderCopy;
+            AsyncResponder asyncResponderCopy;
             int responderTimeoutMs;
             {
                 std::lock_guard<std::mutex> lock(d->callbackMutex_);
                 rawResponderCopy = d->rawResponder;
                 mappedResponderCopy = d->mappedResponder;
+                asyncResponderCopy = d->asyncResponder;
                 responderTimeoutMs = d->responderTimeoutMs;
             }
 
+            // 方式零：asyncResponder 接管（不接管时继续走下面的同步回调）
+            bool handledAsync = false;
+            if (asyncResponderCopy) {
+                auto state = std::make_shared<EAPResponseHandle::State>();
+                {
+                    std::lock_guard<std::mutex> lock(d->pendingMutex_);
+                    d->pendingResponses.push_back(state);
+                }
+                try {
+                    handledAsync = asyncResponderCopy(functionName, reqObj, mapped1, EAPResponseHandle(state));
+                }
+                catch (...) {
+                    handledAsync = true;
+                    state->settle(EAPResponseHandle::State::Phase::Cancelled);
+                }
+
+                if (!handledAsync) {
+                    state->settle(EAPResponseHandle::State::Phase::Cancelled);
+                    std::lock_guard<std::mutex> lock(d->pendingMutex_);
+                    d->pendingResponses.erase(std::remove(d->pendingResponses.begin(), d->pendingResponses.end(), state),
+                        d->pendingResponses.end());
+                }
+                else {
+                    // 异步响应始终有等待上限：等待期间 HTTP 工作线程仍被占住，未设置回调超时时取本接口的
+                    // timeoutMs（默认 5000），卡住的处理不会把整个线程池按 30 s 占满；接口未配置时才取 kDefaultAsyncTimeoutMs
+                    int asyncTimeoutMs = responderTimeoutMs;
+                    if (asyncTimeoutMs <= 0) asyncTimeoutMs = meta.timeoutMs;
+                    if (asyncTimeoutMs <= 0) asyncTimeoutMs = kDefaultAsyncTimeoutMs;
+                    QJsonObject outObj;
+                    const auto phase = d->waitResponse(state, asyncTimeoutMs, outObj);
+                    if (phase == EAPResponseHandle::State::Phase::Finished) {
+                        respJson = makeRawResponse(outObj);
+                    }
+                    else if (phase == EAPResponseHandle::State::Phase::Expired) {
+                        status = 504;
+                        respJson = EAPEnvelope::makeResponseEnvelope(QJsonObject(), reqObj, envelopeCfg, true,
+                            makeDefaultHeadNG("EIC0504", "Handler timeout"));
+
+                        QMetaObject::invokeMethod(this, [this, functionName, asyncTimeoutMs, remote]() {
+                            emit responderTimeout(functionName, asyncTimeoutMs, remote);
+                            }, Qt::QueuedConnection);
+                    }
+                    else {
+                        // 回调异常或服务停止
+                        status = 503;
+                        respJson = EAPEnvelope::makeResponseEnvelope(QJsonObject(), reqObj, envelopeCfg, true,
+                            makeDefaultHeadNG("EIC0503", "Handler cancelled"));
+                    }
+                }
+            }
+
+            if (handledAsync) {
+                // 已由异步回调给出响应
+            }
             // 方式一：rawResponder
-            if (rawResponderCopy) {
+            else if (rawResponderCopy) {
                 auto job = [rawResponderCopy, functionName, reqObj, mapped1]() -> QJsonObject {
                     return rawResponderCopy(functionName, reqObj, mapped1);
                     };
@@ -772,21 +938,8 @@ bool EAPWebService::start(quint16 port, const QString& host) {
                         }, Qt::QueuedConnection);
                 }
                 else {
-                    if (outObj.isEmpty()) {
-                        // 空 -> 默认 ACK
-                        if (hadEnvelope) {
-                            respJson = EAPEnvelope::makeResponseEnvelope(QJsonObject(), reqObj, envelopeCfg, true,
-                                makeDefaultHeadOK());
-                        }
-                        else {
-                            respJson = QJsonObject{ {"code", 0}, {"message", "OK"} };
-                        }
-                    }
-                    else {
-                        // 业务返回任意 JSON；若是 {header,body} 则会被包成响应外壳
-                        respJson = EAPEnvelope::makeResponseEnvelope(outObj, reqObj, envelopeCfg, hadEnvelope,
-                            makeDefaultHeadOK());
-                    }
+                    // 业务返回任意 JSON；空 -> 默认 ACK，{header,body} 会被包成响应外壳
+                    respJson = makeRawResponse(outObj);
                 }
             }
             // 方式二：mappedResponder
@@ -837,13 +990,13 @@ bool EAPWebService::start(quint16 port, const QString& host) {
                 }
             }
 
-            const std::string body = jsonString(respJson);
             res.status = status;
-            res.set_content(body, "application/json");
+            const QByteArray& body = setJsonContent(res, respJson);
 
-            // 记录发送的响应
-          // 记录发送的响应
-            LOG_TYPE_DEBUG("MES", "webservice response  [{}]", body);
+            // 记录发送的响应（与接收日志相同，debug 关闭时不格式化响应体）
+            if (LOG_TYPE_DEBUG_ENABLED("MES")) {
+                LOG_TYPE_DEBUG("MES", "webservice response  [{}]", body.constData());
+            }
             {
                 EAPMessageRecord record;
                 record.timestamp = QDateTime::currentDateTime();
@@ -24,10 +24,50 @@ EAPWebService（服务端）
 class EAPMessageLogger;
 class EAPDataCache;
 
+/**
+ * @brief 异步响应句柄
+ *
+ * 异步回调拿到句柄后可立即返回，在任意线程稍后调用 finish() 给出响应；
+ * EAPWebService 保持 HTTP 连接直到 finish() 或超过回调超时时间
+ * （setResponderTimeoutMs，未设置时为该接口配置的 timeoutMs，接口未配置时为 EAPWebService::kDefaultAsyncTimeoutMs）。
+ * 等待期间 HTTP 工作线程仍被占用，异步模式只限定占用时长。
+ * 句柄可拷贝，多次 finish() 只有第一次生效；超时或服务停止后 finish() 返回 false、结果被丢弃。
+ */
+class EAPCORE_EXPORT EAPResponseHandle {
+public:
+    struct State;
+
+    EAPResponseHandle() = default;
+
+    bool isValid() const { return static_cast<bool>(s_); }
+
+    /**
+     * @brief 完成请求
+     * @param response 与 rawResponder 返回值语义相同：空对象为默认 ACK，{header,body} 会被包成响应外壳
+     * @return true 表示结果已被采用；false 表示句柄无效、已完成、已超时或服务已停止
+     */
+    bool finish(const QJsonObject& response = QJsonObject()) const;
+
+    /** @brief 请求是否已结束（完成、超时或取消），长任务可据此提前放弃 */
+    bool isDone() const;
+
+private:
+    explicit EAPResponseHandle(std::shared_ptr<State> s) : s_(std::move(s)) {}
+    std::shared_ptr<State> s_;
+    friend class EAPWebService;
+};
+
 class EAPCORE_EXPORT EAPWebService : public QObject {
     Q_OBJECT
 public:
     using Provider = std::function<QVariantMap(const QString& fn, const QJsonObject& reqJson, const QVariantMap& mappedReq)>;
+    // 异步回调：返回 true 表示接管该请求（稍后通过 handle.finish() 响应），false 表示不处理、交给 raw/mapped 回调
+    using AsyncResponder = std::function<bool(const QString& fn, const QJsonObject& reqJson, const QVariantMap& mappedParams,
+        EAPResponseHandle handle)>;
+
+    // 未设置回调超时（setResponderTimeoutMs <= 0）且接口 timeoutMs <= 0 时异步响应的等待上限（毫秒），
+    // 避免 HTTP 工作线程被无限期占住
+    static constexpr int kDefaultAsyncTimeoutMs = 30000;
 
     explicit EAPWebService(QObject* parent = nullptr);
     ~EAPWebService() override;
@@ -55,7 +95,8 @@ public:
     void setNetworkTimeouts(int readTimeoutMs, int writeTimeoutMs, int idleIntervalMs);
     void setAutoStopOnAppQuit(bool on);
 
-    // 响应回调（选其一；raw 优先）
+    // 响应回调（async 先于其它回调判断是否接管；raw / mapped 选其一，raw 优先）
+    void setAsyncResponder(AsyncResponder cb);
     void setRawResponder(std::function<QJsonObject(const QString& fn,
         const QJsonObject& reqJson,
         const QVariantMap& mappedParams)> cb);
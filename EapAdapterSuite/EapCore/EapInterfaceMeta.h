@@ -3,6 +3,7 @@
 #include <QString>
 #include <QMap>
 #include <QVariant>
+#include <QStringList>
 /**
  * 成功判定策略
  */
@@ -31,6 +32,60 @@ struct RetryStrategy {
     bool enabled = false;           // 是否启用基于响应的重试策略
 };
 
+/**
+ * 自适应超时配置
+ * 有效超时 = clamp(k × p99, minMs, maxMs)；样本数不足 minSamples 时仍使用 timeoutMs
+ */
+struct AdaptiveTimeout {
+    bool enabled = false;           // 是否启用自适应超时
+    double k = 3.0;                 // p99 放大系数
+    int minMs = 200;                // 下限（ms）
+    int maxMs = 30000;              // 上限（ms）
+    int minSamples = 20;            // 启用前所需的最少样本数
+};
+
+/**
+ * 对冲请求策略（仅 direction 为 pull 的幂等查询生效）
+ * 主请求超过对冲延迟仍未返回时再发一路相同请求，先返回者胜出，另一路中止
+ */
+struct HedgePolicy {
+    int afterMs = 0;                // 固定对冲延迟（ms），0 表示不使用
+    double atPercentile = 0.0;      // 按观测延迟分位数对冲（如 0.95），0 表示不使用
+    double maxRatio = 0.1;          // 对冲请求占主请求的最大比例（防止故障期放大负载）
+    int minSamples = 20;            // 分位数对冲所需的最少样本数，不足时回退到 afterMs
+
+    bool isEnabled() const { return afterMs > 0 || atPercentile > 0.0; }
+};
+
+/**
+ * 批量上传策略（仅经上传队列发送的接口生效）
+ * 同一分组（如同一批次）的多条排队记录合并为一次请求，body 中 name[] 路径按记录逐项追加
+ */
+struct BatchPolicy {
+    int maxItems = 0;               // 单次合并的记录上限，<= 1 表示不合并
+    int lingerMs = 0;               // 不足上限时，最早一条记录最多等待的时间（ms）
+    QString groupKey;               // 分组字段（本地字段名，如 lot_id），为空表示同接口的记录都可合并
+    QString itemKey;                // 记录标识字段（本地字段名，如 pnl_id），用于逐项确认
+    QString failedItemsKey;         // 映射后的响应中列出失败记录标识的本地字段（数组或逗号分隔），为空表示整批确认
+    int maxAttempts = 5;            // 单条记录被逐项拒绝的次数上限，达到后转入死信（不再发送），<= 0 表示不限
+
+    bool isEnabled() const { return maxItems > 1; }
+};
+
+/**
+ * 上传队列保留策略（离线期间积压记录的压缩规则）
+ * replay_all：全部按序补传；latest_only_per_key：同一键只保留最新一条（状态、心跳类）
+ * dropWhenStaleAfterMs 与模式独立，超过时限的记录直接丢弃
+ */
+struct QueuePolicy {
+    enum class Mode { ReplayAll, LatestOnlyPerKey };
+    Mode mode = Mode::ReplayAll;
+    QStringList keyFields;          // 取代键字段（本地字段名，如 eqp_id / carrier_id），为空表示整个接口只留最新一条
+    qint64 dropWhenStaleAfterMs = 0; // 入队超过该时长（ms）的记录丢弃，0 表示不丢弃
+
+    bool needsCompaction() const { return mode != Mode::ReplayAll || dropWhenStaleAfterMs > 0; }
+};
+
 /**
  * 描述一个 WebAPI 接口的结构配置
  */
@@ -60,6 +115,26 @@ struct EapInterfaceMeta {
     // === 重试策略配置 ===
     RetryStrategy retryStrategy;          // 基于响应内容的重试策略
 
+    // === 自适应超时配置 ===
+    AdaptiveTimeout adaptiveTimeout;      // 按观测延迟分位数推导有效超时
+
+    // === 对冲请求配置 ===
+    HedgePolicy hedgePolicy;              // pull 接口慢请求对冲
+
+    // === 响应缓存配置（仅 pull 接口） ===
+    int cacheTtlMs = 0;                   // 响应缓存有效期（ms），0 表示不缓存；启用后相同请求并发时合并为一次调用
+    QStringList cacheIgnoreFields;        // 计算缓存键时忽略的易变字段（默认 trx_id / time_stamp 等）
+
+    // === 批量上传配置（仅 push 接口经上传队列发送时） ===
+    BatchPolicy batch;                    // 同批次记录合并上传与逐项确认
+    QueuePolicy queuePolicy;              // 离线积压记录的取代 / 过期压缩规则
+
+    // === 离线 / 半自动分发配置（EAPDispatcher） ===
+    bool offlineEnabled = false;          // 离线（Local）时仍直接发送
+    bool offlineCache = false;            // 离线时写入上传队列，重新上线后补传
+    bool semiAutoEnabled = true;          // 半自动（Semi-Auto）模式下允许发送
+    bool dispatchFlagsConfigured = false; // 配置中出现了上述任一字段；否则按调用方的旧判断分发
+
     // === 数据持久化配置 ===
     QString saveToDb;                     // 数据库持久化配置，格式：function_name.db_key
     // 如果配置了此字段，响应数据会按此唯一键存储到数据库
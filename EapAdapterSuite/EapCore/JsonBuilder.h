@@ -2,14 +2,41 @@
 
 #include <QJsonObject>
 #include <QVariantMap>
+#include <QVector>
 #include "EapInterfaceMeta.h"
 #include "eapcore_global.h"
+
+class JsonTree;
+
 class EAPCORE_EXPORT JsonBuilder {
 public:
+    // 分组提取的扁平结果：keys[i] 与 values[i] 一一对应，按分组键首次出现的顺序排列；
+    // 同一分组键出现多次时取最后一次的值（与写入 QMap 的覆盖语义一致）
+    struct GroupedValues {
+        QString innerKey;          // 分组内字段名（如 "pnl_id"）
+        QVector<QString> keys;     // 分组键（如 lot_id）
+        QVector<QVariant> values;  // 余下路径在对应元素上的求值结果
+    };
+
+    // 分组数组元素数达到该值时才拆分到线程池并行求值
+    static constexpr int kParallelGroupThreshold = 64;
+
+    // 批量记录参数键：值为 QVariantList<QVariantMap>，每条记录按 body 映射写入一次，
+    // name[] 路径逐条追加为数组元素，其余字段只由第一条记录写入（合并前须经 batchCompatible 判断）
+    static constexpr const char* kBatchItemsKey = "__batch__";
+
+    // 记录能否与第一条记录合并为一次批量请求：只写一次的 body 字段（普通字段、lot[].TOKEN、
+    // parameter_list 等）取值须相同，否则后一条的值会被丢弃
+    static bool batchCompatible(const EapInterfaceMeta& meta, const QVariantMap& first, const QVariantMap& record);
+
     // 构造 JSON 请求包（包含 header + body）
     static QJsonObject buildPayload(const EapInterfaceMeta& meta,
         const QVariantMap& localParams);
 
+    // 在构建树上装配请求包（调用方可在同一棵树上继续注入字段，最后一次性转换为 QJsonObject）
+    static void buildPayloadInto(const EapInterfaceMeta& meta,
+        const QVariantMap& localParams, JsonTree& tree);
+
     // 解析 JSON 响应，提取映射字段（返回设备字段结构）
     static QVariantMap parseResponse(const EapInterfaceMeta& meta,
         const QJsonObject& response);
@@ -31,4 +58,9 @@ public:
 //   QMap<lot_id, QVariantMap>，例如 { "A2405...23" => { "pnl_id": QStringList{...} }, ... }
     static QMap<QString, QVariantMap> buildGroupedByArrayKey(const QString& groupPath,
         const QJsonObject& response);
+
+    // 与 buildGroupedByArrayKey 语义相同，结果为扁平数组；
+    // 分组数组元素数 >= parallelThreshold 时按块分到全局线程池（QtConcurrent）并行求值，否则顺序执行
+    static GroupedValues extractGroupedByArrayKey(const QString& groupPath,
+        const QJsonObject& response, int parallelThreshold = kParallelGroupThreshold);
 };
\ No newline at end of file
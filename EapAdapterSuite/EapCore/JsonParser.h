@@ -24,26 +24,4 @@ public:
     // - 若未匹配到任何值，返回 invalid QVariant()
     static QVariant resolvePlaceholderValue(const QJsonObject& normalized, const QString& placeholder);
 
-
-private:
-    struct PathElement {
-        enum Kind {
-            Field, Index
-        } kind;
-        QString field;  // kind == Field
-        int index = -1; // kind == Index
-    };
-
-    // 将如 "a.b[0].c[1][2]" 切分为 {Field:a, Field:b, Index:0, Field:c, Index:1, Index:2}
-    static QList<PathElement> tokenizePath(const QString& path); 
-
-    // 兼容“键值对数组”老语义路径：
-    // [body|request_body].(parameter_list|para_list).(parameter_name|para_name).(parameter_value|para_value).<matchKey>
-    // 命中后会在对应数组中找到 key=matchKey 的项并返回其 value
-    static bool isKvArrayPath(const QStringList& parts,
-        int& baseIndex,
-        QString& arrayName,
-        QString& keyField,
-        QString& valField,
-        QString& matchKey);
 };
\ No newline at end of file
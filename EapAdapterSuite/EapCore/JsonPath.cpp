@@ -0,0 +1,719 @@
+﻿#include "JsonPath.h"
+
+#include <QHash>
+#include <QJsonArray>
+#include <QReadWriteLock>
+#include <QRegularExpression>
+
+#pragma execution_character_set("utf-8")
+
+namespace {
+
+// 编译缓存：按语法分桶，键为原始路径字符串（路径来自配置，数量有限；超限整体清空兜底）
+struct PathCache {
+    QReadWriteLock lock;
+    QHash<QString, JsonPath::Ptr> buckets[JsonPath::Plain + 1];
+};
+
+PathCache& pathCache()
+{
+    static PathCache cache;
+    return cache;
+}
+
+const int kMaxCachedPaths = 4096;
+
+inline bool ieq(const QString& a, const char* b)
+{
+    return a.compare(QLatin1String(b), Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * @brief 按查找规则展开同义键名（编译期调用一次）
+ * @param key  路径中的字段名
+ * @param mode 查找规则
+ * @return 在 key 本身不存在时依次尝试的键名
+ */
+QStringList alternatesFor(const QString& key, JsonPath::Lookup mode)
+{
+    const QString k = key.toLower();
+    switch (mode) {
+    case JsonPath::Lookup::Synonyms:
+        if (k == QLatin1String("body"))
+            return { QStringLiteral("request_body"), QStringLiteral("response_body") };
+        if (k == QLatin1String("header") || k == QLatin1String("head"))
+            return { QStringLiteral("request_head"), QStringLiteral("response_head"),
+                     QStringLiteral("header"), QStringLiteral("head") };
+        if (k == QLatin1String("request_body") || k == QLatin1String("response_body"))
+            return { QStringLiteral("body") };
+        if (k == QLatin1String("request_head") || k == QLatin1String("response_head"))
+            return { QStringLiteral("header"), QStringLiteral("head") };
+        break;
+    case JsonPath::Lookup::Alias:
+        if (k == QLatin1String("body")) return { QStringLiteral("request_body") };
+        if (k == QLatin1String("header")) return { QStringLiteral("request_head") };
+        if (k == QLatin1String("request_body")) return { QStringLiteral("body") };
+        if (k == QLatin1String("request_head")) return { QStringLiteral("header") };
+        break;
+    case JsonPath::Lookup::SectionOrSelf:
+        if (k == QLatin1String("body")) return { QStringLiteral("request_body") };
+        break;
+    case JsonPath::Lookup::Exact:
+        break;
+    }
+    return {};
+}
+
+JsonPath::Step makeStep(JsonPath::Kind kind, const QString& raw, const QString& name, JsonPath::Lookup lookup)
+{
+    JsonPath::Step s;
+    s.kind = kind;
+    s.raw = raw;
+    s.name = name;
+    s.lookup = lookup;
+    s.alternates = alternatesFor(name, lookup);
+    return s;
+}
+
+/**
+ * @brief 读取字段（含同义键名），未命中返回 Undefined
+ */
+QJsonValue lookupValue(const QJsonObject& obj, const JsonPath::Step& s)
+{
+    auto it = obj.constFind(s.name);
+    if (it != obj.constEnd()) return it.value();
+    for (const QString& alt : s.alternates) {
+        it = obj.constFind(alt);
+        if (it != obj.constEnd()) return it.value();
+    }
+    return QJsonValue(QJsonValue::Undefined);
+}
+
+/**
+ * @brief 写入时确定实际键名：已存在的同义键优先，否则使用路径中的字段名（新建）
+ */
+QString writeKey(const JsonTree& tree, JsonTree::NodeId obj, const JsonPath::Step& s)
+{
+    if (tree.contains(obj, s.name)) return s.name;
+    for (const QString& alt : s.alternates) {
+        if (tree.contains(obj, alt)) return alt;
+    }
+    return s.name;
+}
+
+bool kvHitKey(const QString& keyVal, const JsonPath::Step& s)
+{
+    if (s.caseInsensitive)
+        return (s.trimKey ? keyVal.trimmed() : keyVal).compare(s.token, Qt::CaseInsensitive) == 0;
+    return keyVal == s.token;
+}
+
+bool kvHit(const QJsonObject& item, const JsonPath::Step& s)
+{
+    return kvHitKey(item.value(s.keyField).toString(), s);
+}
+
+/**
+ * @brief 在构建树的键值数组中查找 keyField == token 的元素（树内按需建立哈希索引），未命中返回 InvalidNode
+ */
+JsonTree::NodeId findKvItem(const JsonTree& tree, JsonTree::NodeId arr, const JsonPath::Step& s)
+{
+    return tree.findByKey(arr, s.keyField, s.token, s.caseInsensitive);
+}
+
+/**
+ * @brief 解析 name[] / name[]{...} 段的键值字段配置
+ * @param seg       路径片段，如 "lot[]"、"lot[]{item_id,item_value}"、"lot[]{key=lot_id}"
+ * @param arrayName [out] 数组名
+ * @param keyField  [in,out] 键字段（默认 item_id）
+ * @param valField  [in,out] 值字段（默认 item_value）
+ * @return seg 是否为 name[] / name[]{...} 形式
+ */
+bool parseKvSegment(const QString& seg, QString& arrayName, QString& keyField, QString& valField)
+{
+    static const QRegularExpression re(QStringLiteral("^(\\w+)\\[\\](?:\\{([^}]*)\\})?$"));
+    const auto m = re.match(seg);
+    if (!m.hasMatch()) return false;
+
+    arrayName = m.captured(1);
+    const QString opts = m.captured(2).trimmed();
+    if (opts.isEmpty()) return true;
+
+    if (opts.contains('=')) {
+        for (const QString& p : opts.split(',')) {
+            const int eq = p.indexOf('=');
+            if (eq <= 0) continue;
+            const QString k = p.left(eq).trimmed().toLower();
+            const QString v = p.mid(eq + 1).trimmed();
+            if (k == QLatin1String("key") || k == QLatin1String("k") || k == QLatin1String("id")) {
+                keyField = v;
+            }
+            else if (k == QLatin1String("value") || k == QLatin1String("v")) {
+                valField = v;
+            }
+        }
+    }
+    else {
+        const QStringList two = opts.split(',');
+        if (two.size() >= 2) {
+            keyField = two[0].trimmed();
+            valField = two[1].trimmed();
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 识别老“键值对数组”路径
+ * @param parts            按 '.' 拆分的片段
+ * @param allowRequestBody 前缀是否也允许 request_body（JsonParser 语义），否则仅 body
+ * @param out              [out] 拆解结果
+ */
+bool detectLegacyKv(const QStringList& parts, bool allowRequestBody, JsonPath::LegacyKv& out)
+{
+    if (parts.size() < 4) return false;
+    int s = 0;
+    if (ieq(parts[0], "body") || (allowRequestBody && ieq(parts[0], "request_body"))) {
+        s = 1;
+        if (parts.size() - s < 4) return false;
+    }
+    const QString& k = parts[s + 1];
+    const QString& v = parts[s + 2];
+    if (!ieq(k, "parameter_name") && !ieq(k, "para_name")) return false;
+    if (!ieq(v, "parameter_value") && !ieq(v, "para_value")) return false;
+
+    out.baseIndex = s;
+    out.arrayName = parts[s + 0];
+    out.keyField = k;
+    out.valField = v;
+    out.matchKey = parts[s + 3];
+    return true;
+}
+
+/**
+ * @brief 推断分组结果中的字段名：余下路径中最后一个形如 name / name[...] 的片段
+ */
+QString extractLastFieldKey(const QStringList& parts)
+{
+    static const QRegularExpression reField(QStringLiteral("^(\\w+)(?:\\[.*\\])?$"));
+    for (int i = parts.size() - 1; i >= 0; --i) {
+        const auto m = reField.match(parts[i]);
+        if (m.hasMatch()) return m.captured(1);
+    }
+    return QStringLiteral("value");
+}
+
+/**
+ * @brief 按 JsonParser 语法切分 "a.b[0][1]" / "[2].c"（段首尾空白忽略）
+ * @return false 表示下标语法非法
+ */
+bool tokenizeIndexed(const QString& path, QVector<JsonPath::Step>& out)
+{
+    for (const QString& segRaw : path.split('.')) {
+        const QString seg = segRaw.trimmed();
+        if (seg.isEmpty()) continue;
+
+        const int n = seg.size();
+        QString fieldBuf;
+        auto pushField = [&]() {
+            if (fieldBuf.isEmpty()) return;
+            out.push_back(makeStep(JsonPath::Kind::Field, fieldBuf, fieldBuf, JsonPath::Lookup::Alias));
+            fieldBuf.clear();
+        };
+
+        int i = 0;
+        while (i < n) {
+            const QChar ch = seg.at(i);
+            if (ch != QLatin1Char('[')) {
+                fieldBuf.append(ch);
+                ++i;
+                continue;
+            }
+            pushField();
+
+            int j = i + 1;
+            bool neg = false;
+            if (j < n && seg.at(j) == QLatin1Char('-')) {
+                neg = true; ++j;
+            }
+            int val = 0;
+            bool hasDigit = false;
+            while (j < n && seg.at(j).isDigit()) {
+                hasDigit = true;
+                val = val * 10 + (seg.at(j).unicode() - '0');
+                ++j;
+            }
+            if (!hasDigit || j >= n || seg.at(j) != QLatin1Char(']')) return false;
+
+            JsonPath::Step s = makeStep(JsonPath::Kind::Index, seg.mid(i, j - i + 1), QString(), JsonPath::Lookup::Exact);
+            s.index = neg ? -val : val;
+            out.push_back(s);
+            i = j + 1;
+        }
+        pushField();
+    }
+    return true;
+}
+
+} // namespace
+
+JsonPath::Ptr JsonPath::compile(const QString& path, Syntax syntax)
+{
+    PathCache& cache = pathCache();
+    {
+        QReadLocker locker(&cache.lock);
+        const auto it = cache.buckets[syntax].constFind(path);
+        if (it != cache.buckets[syntax].constEnd()) return it.value();
+    }
+
+    // 在锁外编译（分组路径会递归编译父路径/余下路径）
+    const Ptr compiled = build(path, syntax);
+
+    QWriteLocker locker(&cache.lock);
+    QHash<QString, Ptr>& bucket = cache.buckets[syntax];
+    const auto it = bucket.constFind(path);
+    if (it != bucket.constEnd()) return it.value();
+    if (bucket.size() >= kMaxCachedPaths) bucket.clear();
+    bucket.insert(path, compiled);
+    return compiled;
+}
+
+JsonPath::Ptr JsonPath::build(const QString& path, Syntax syntax)
+{
+    QSharedPointer<JsonPath> p(new JsonPath);
+    p->text_ = path;
+    p->syntax_ = syntax;
+
+    const QStringList parts = path.split('.');
+
+    // 老键值数组写法：Plain / Append 仅认 body 前缀，Indexed 额外认 request_body
+    if (syntax == Plain || syntax == Append || syntax == Indexed) {
+        p->hasLegacy_ = detectLegacyKv(parts, syntax == Indexed, p->legacy_);
+    }
+
+    switch (syntax) {
+    case Extended: {
+        static const QRegularExpression reIndex(QStringLiteral("^(\\w+)\\[(-?\\d+)\\]$"));
+        static const QRegularExpression reCollect(QStringLiteral("^(\\w+)\\[\\*\\]$"));
+
+        int groupIdx = -1;
+        for (int i = 0; i < parts.size(); ++i) {
+            const QString& seg = parts[i];
+
+            auto m = reIndex.match(seg);
+            if (m.hasMatch()) {
+                Step s = makeStep(Kind::Index, seg, m.captured(1), Lookup::Synonyms);
+                s.index = m.captured(2).toInt();
+                s.nullAsEmpty = true;
+                p->steps_.push_back(s);
+                continue;
+            }
+            m = reCollect.match(seg);
+            if (m.hasMatch()) {
+                p->steps_.push_back(makeStep(Kind::Wildcard, seg, m.captured(1), Lookup::Synonyms));
+                ++p->wildcardDepth_;
+                continue;
+            }
+            QString arrayName;
+            QString keyField = QStringLiteral("item_id");
+            QString valField = QStringLiteral("item_value");
+            if (parseKvSegment(seg, arrayName, keyField, valField)) {
+                if (groupIdx < 0) groupIdx = i;
+                Step s = makeStep(Kind::KvMatch, seg, arrayName, Lookup::Synonyms);
+                s.keyField = keyField;
+                s.valField = valField;
+                // 下一段是要匹配的 TOKEN
+                if (i + 1 < parts.size()) {
+                    s.token = parts[i + 1];
+                    s.hasToken = true;
+                    p->hasKvMatch_ = true;
+                    ++i;
+                }
+                p->steps_.push_back(s);
+                continue;
+            }
+            p->steps_.push_back(makeStep(Kind::Field, seg, seg, Lookup::Synonyms));
+        }
+
+        if (groupIdx >= 0) {
+            QSharedPointer<GroupBy> g(new GroupBy);
+            QString arrayName;
+            QString keyField = QStringLiteral("item_id");
+            QString valField = QStringLiteral("item_value");
+            parseKvSegment(parts[groupIdx], arrayName, keyField, valField);
+            g->keyField = keyField;
+
+            QStringList arrayParts = parts.mid(0, groupIdx);
+            arrayParts.append(arrayName);
+            g->array = compile(arrayParts.join('.'), Extended);
+
+            const QStringList restParts = parts.mid(groupIdx + 1);
+            if (!restParts.isEmpty()) {
+                g->nextPart = restParts.front();
+                g->rest = compile(restParts.join('.'), Extended);
+            }
+            g->innerKey = extractLastFieldKey(restParts.isEmpty() ? QStringList{ QStringLiteral("value") } : restParts);
+            p->group_ = g;
+        }
+        break;
+    }
+    case Append: {
+        static const QRegularExpression reAppend(QStringLiteral("^(\\w+)\\[\\]$"));
+        for (const QString& seg : parts) {
+            const auto m = reAppend.match(seg);
+            if (m.hasMatch()) {
+                p->steps_.push_back(makeStep(Kind::AppendItem, seg, m.captured(1), Lookup::Exact));
+                continue;
+            }
+            Step s = makeStep(Kind::Field, seg, seg, Lookup::Exact);
+            s.extendArrays = true;
+            p->steps_.push_back(s);
+        }
+        break;
+    }
+    case Plain:
+    case Indexed: {
+        if (syntax == Indexed && path.trimmed().isEmpty()) {
+            p->valid_ = false;
+            break;
+        }
+        if (p->hasLegacy_) {
+            const LegacyKv& kv = p->legacy_;
+            if (kv.baseIndex == 1) {
+                p->steps_.push_back(makeStep(Kind::Field, parts[0], parts[0],
+                    syntax == Indexed ? Lookup::SectionOrSelf : Lookup::Exact));
+            }
+            Step s = makeStep(Kind::KvMatch, parts[kv.baseIndex], kv.arrayName, Lookup::Exact);
+            s.keyField = kv.keyField;
+            s.valField = kv.valField;
+            s.token = kv.matchKey;
+            s.hasToken = true;
+            s.caseInsensitive = true;
+            s.trimKey = (syntax != Indexed);
+            p->steps_.push_back(s);
+            break;
+        }
+        if (syntax == Plain) {
+            for (const QString& seg : parts)
+                p->steps_.push_back(makeStep(Kind::Field, seg, seg, Lookup::Exact));
+        }
+        else if (!tokenizeIndexed(path, p->steps_) || p->steps_.isEmpty()) {
+            p->steps_.clear();
+            p->valid_ = false;
+        }
+        break;
+    }
+    case Collect: {
+        for (const QString& seg : parts) {
+            if (seg.endsWith(QLatin1String("[]"))) {
+                p->steps_.push_back(makeStep(Kind::Wildcard, seg, seg.left(seg.size() - 2), Lookup::Exact));
+                ++p->wildcardDepth_;
+            }
+            else {
+                p->steps_.push_back(makeStep(Kind::Field, seg, seg, Lookup::Exact));
+            }
+        }
+        break;
+    }
+    }
+
+    // 键值匹配段的数组位置键：同一根对象下，前缀（含之前各匹配段的 TOKEN）相同即为同一数组；
+    // 经过遍历段的数组随元素变化，不建立索引
+    QString prefix = QString::number(syntax);
+    for (Step& s : p->steps_) {
+        prefix += QChar(0x1F) + s.raw;
+        if (s.kind == Kind::Wildcard || s.kind == Kind::AppendItem)
+            break;
+        if (s.kind == Kind::KvMatch) {
+            s.indexKey = prefix + QChar(0x1F) + s.keyField + (s.caseInsensitive ? (s.trimKey ? QStringLiteral("/it") : QStringLiteral("/i")) : QStringLiteral("/s"));
+            prefix += QChar(0x1E) + s.token;
+        }
+    }
+    return p;
+}
+
+JsonPath::Ptr JsonPath::bodyRelative() const
+{
+    const int dot = text_.indexOf('.');
+    if (dot > 0) {
+        const QString first = text_.left(dot);
+        if (ieq(first, "body") || ieq(first, "request_body") || ieq(first, "response_body"))
+            return compile(text_.mid(dot + 1), syntax_);
+    }
+    return compile(text_, syntax_);
+}
+
+QJsonValue JsonPath::read(const QJsonValue& root) const
+{
+    return read(root, nullptr);
+}
+
+QJsonValue JsonPath::read(const QJsonValue& root, ReadScope* scope) const
+{
+    if (!valid_ || steps_.isEmpty()) return QJsonValue(QJsonValue::Undefined);
+    return readAt(root, 0, scope);
+}
+
+int JsonPath::ReadScope::find(const Step& s, const QJsonArray& arr)
+{
+    auto it = indexes_.find(s.indexKey);
+    if (it == indexes_.end()) {
+        // 第一次访问该数组：建立 键值 -> 首个元素下标 的索引
+        QHash<QString, int> index;
+        index.reserve(arr.size());
+        for (int k = 0; k < arr.size(); ++k) {
+            const QJsonValue el = arr.at(k);
+            if (!el.isObject()) continue;
+            const QString keyVal = el.toObject().value(s.keyField).toString();
+            const QString folded = s.caseInsensitive ? (s.trimKey ? keyVal.trimmed() : keyVal).toCaseFolded() : keyVal;
+            if (!index.contains(folded)) index.insert(folded, k);
+        }
+        it = indexes_.insert(s.indexKey, index);
+    }
+    // 查询值不去空白：老语义下只有元素键值做 trimmed 比较
+    return it.value().value(s.caseInsensitive ? s.token.toCaseFolded() : s.token, -1);
+}
+
+QJsonValue JsonPath::readAt(const QJsonValue& node, int i, ReadScope* scope) const
+{
+    if (i >= steps_.size()) return node;
+    const Step& s = steps_[i];
+    const QJsonValue miss(QJsonValue::Undefined);
+
+    // [n] 作用于当前数组
+    if (s.kind == Kind::Index && s.name.isEmpty()) {
+        if (!node.isArray()) return miss;
+        const QJsonArray arr = node.toArray();
+        const int real = s.index < 0 ? arr.size() + s.index : s.index;
+        if (real < 0 || real >= arr.size()) return miss;
+        return readAt(arr.at(real), i + 1, scope);
+    }
+
+    // parseResponse 老语义：中间段缺失或不是对象时得到 null（键仍写入结果），只有末段缺失才算未命中
+    const bool plainNull = (syntax_ == Plain && !hasLegacy_);
+    if (!node.isObject()) return plainNull ? QJsonValue(QJsonValue::Null) : miss;
+    const QJsonObject obj = node.toObject();
+
+    // 老键值数组前缀：取不到对象段时停留在当前对象
+    if (s.lookup == Lookup::SectionOrSelf) {
+        const auto it = obj.constFind(s.name);
+        if (it != obj.constEnd() && it.value().isObject()) return readAt(it.value(), i + 1, scope);
+        for (const QString& alt : s.alternates) {
+            if (obj.contains(alt)) return readAt(obj.value(alt).toObject(), i + 1, scope);
+        }
+        return readAt(obj, i + 1, scope);
+    }
+
+    const QJsonValue v = lookupValue(obj, s);
+    switch (s.kind) {
+    case Kind::Field:
+        if (v.isUndefined()) return (plainNull && i + 1 < steps_.size()) ? QJsonValue(QJsonValue::Null) : miss;
+        return readAt(v, i + 1, scope);
+
+    case Kind::Index: {
+        if (s.nullAsEmpty && (v.isUndefined() || v.isNull())) return QJsonArray();
+        if (!v.isArray()) return miss;
+        const QJsonArray arr = v.toArray();
+        const int real = s.index < 0 ? arr.size() + s.index : s.index;
+        if (real < 0 || real >= arr.size()) return miss;
+        return readAt(arr.at(real), i + 1, scope);
+    }
+
+    case Kind::Wildcard:
+    case Kind::AppendItem: {
+        if (v.isUndefined() || v.isNull()) return QJsonArray();
+        if (!v.isArray()) return miss;
+        const QJsonArray arr = v.toArray();
+        QJsonArray out;
+        for (const QJsonValue& el : arr) {
+            const QJsonValue r = readAt(el, i + 1, nullptr);  // 各元素下的数组不同，不共享索引
+            if (!r.isUndefined() && !r.isNull()) out.append(r);
+        }
+        return out;
+    }
+
+    case Kind::KvMatch: {
+        if (!s.hasToken || !v.isArray()) return miss;
+        const QJsonArray arr = v.toArray();
+        if (scope && !s.indexKey.isEmpty()) {
+            const int k = scope->find(s, arr);
+            if (k < 0) return miss;
+            const QJsonObject item = arr.at(k).toObject();
+            if (i + 1 >= steps_.size()) return item.value(s.valField);
+            return readAt(item, i + 1, scope);
+        }
+        for (const QJsonValue& el : arr) {
+            if (!el.isObject()) continue;
+            const QJsonObject item = el.toObject();
+            if (!kvHit(item, s)) continue;
+            if (i + 1 >= steps_.size()) return item.value(s.valField);
+            return readAt(item, i + 1, scope);
+        }
+        return miss;
+    }
+    }
+    return miss;
+}
+
+bool JsonPath::write(QJsonObject& root, const QJsonValue& value) const
+{
+    JsonTree tree(root);
+    if (!write(tree, tree.root(), value)) return false;
+    root = tree.toObject();
+    return true;
+}
+
+bool JsonPath::write(JsonTree& tree, JsonTree::NodeId obj, const QJsonValue& value) const
+{
+    if (!valid_ || steps_.isEmpty() || !tree.isObject(obj)) return false;
+    // 先只读判定能否写入，保证失败时树不被修改（与按值拷贝写入的语义一致）
+    if (!writableAt(tree, obj, 0)) return false;
+    writeAt(tree, obj, 0, value);
+    return true;
+}
+
+bool JsonPath::writableAt(const JsonTree& tree, JsonTree::NodeId obj, int i) const
+{
+    // obj 为 InvalidNode 表示写入时才会新建的空对象
+    if (i >= steps_.size()) return false;
+    const Step& s = steps_[i];
+    const bool last = (i + 1 >= steps_.size());
+    auto objectOrNew = [&tree](JsonTree::NodeId n) {
+        return tree.isObject(n) ? n : JsonTree::InvalidNode;
+    };
+
+    switch (s.kind) {
+    case Kind::Field: {
+        if (last) return true;
+        const JsonTree::NodeId cur = tree.member(obj, writeKey(tree, obj, s));
+        if (s.extendArrays && tree.isArray(cur)) return true;
+        return writableAt(tree, objectOrNew(cur), i + 1);
+    }
+
+    case Kind::AppendItem:
+        return true;
+
+    case Kind::Index: {
+        if (s.name.isEmpty()) return false;
+        const JsonTree::NodeId arr = tree.member(obj, writeKey(tree, obj, s));
+        const int n = tree.size(arr);
+        const int real = s.index < 0 ? n + s.index : s.index;
+        if (real < 0) return false;
+        if (last) return true;
+        return writableAt(tree, real < n ? objectOrNew(tree.item(arr, real)) : JsonTree::InvalidNode, i + 1);
+    }
+
+    case Kind::Wildcard: {
+        const JsonTree::NodeId arr = tree.member(obj, writeKey(tree, obj, s));
+        const int n = tree.size(arr);
+        if (n == 0) return last || writableAt(tree, JsonTree::InvalidNode, i + 1);
+        for (int k = 0; k < n; ++k) {
+            const JsonTree::NodeId el = tree.item(arr, k);
+            if (tree.isObject(el) && writableAt(tree, el, i + 1)) return true;
+        }
+        return false;
+    }
+
+    case Kind::KvMatch: {
+        if (!s.hasToken) return false;
+        if (last) return true;
+        // 新建的 {keyField: TOKEN} 对余下路径而言等同空对象
+        const JsonTree::NodeId arr = tree.member(obj, writeKey(tree, obj, s));
+        return writableAt(tree, findKvItem(tree, arr, s), i + 1);
+    }
+    }
+    return false;
+}
+
+void JsonPath::writeAt(JsonTree& tree, JsonTree::NodeId obj, int i, const QJsonValue& value) const
+{
+    const Step& s = steps_[i];
+    const bool last = (i + 1 >= steps_.size());
+
+    switch (s.kind) {
+    case Kind::Field: {
+        const QString key = writeKey(tree, obj, s);
+        if (last) {
+            tree.setValue(obj, key, value);
+            return;
+        }
+        const JsonTree::NodeId cur = tree.member(obj, key);
+
+        // 已有数组时 items.xxx 在最后一项上续写（最后一项已含该字段则另起一项）
+        if (s.extendArrays && tree.isArray(cur)) {
+            const QString& tailHead = steps_[i + 1].raw;
+            const int n = tree.size(cur);
+            const JsonTree::NodeId lastItem = n > 0 ? tree.item(cur, n - 1) : JsonTree::InvalidNode;
+            if (i + 2 >= steps_.size()) {
+                const JsonTree::NodeId target = (tree.isObject(lastItem) && !tree.contains(lastItem, tailHead))
+                    ? lastItem : tree.appendObject(cur);
+                tree.setValue(target, tailHead, value);
+            }
+            else {
+                const JsonTree::NodeId target = tree.isObject(lastItem) ? lastItem : tree.appendObject(cur);
+                if (writableAt(tree, target, i + 1)) writeAt(tree, target, i + 1, value);
+            }
+            return;
+        }
+
+        writeAt(tree, tree.objectAt(obj, key), i + 1, value);
+        return;
+    }
+
+    case Kind::AppendItem: {
+        // name[]：追加；余下路径优先复用尚未包含该字段的最后一项（id/value 自动配对）
+        const JsonTree::NodeId arr = tree.arrayAt(obj, s.name);
+        if (last) {
+            tree.appendValue(arr, value);
+            return;
+        }
+        const QString& tailHead = steps_[i + 1].raw;
+        const int n = tree.size(arr);
+        const JsonTree::NodeId lastItem = n > 0 ? tree.item(arr, n - 1) : JsonTree::InvalidNode;
+        const JsonTree::NodeId target = (tree.isObject(lastItem) && !tree.contains(lastItem, tailHead))
+            ? lastItem : tree.appendObject(arr);
+        if (writableAt(tree, target, i + 1)) writeAt(tree, target, i + 1, value);
+        return;
+    }
+
+    case Kind::Index: {
+        const JsonTree::NodeId arr = tree.arrayAt(obj, writeKey(tree, obj, s));
+        const int real = s.index < 0 ? tree.size(arr) + s.index : s.index;
+        // 扩展数组以容纳下标
+        while (real >= tree.size(arr)) tree.appendObject(arr);
+        if (last) tree.setItem(arr, real, value);
+        else writeAt(tree, tree.objectItem(arr, real), i + 1, value);
+        return;
+    }
+
+    case Kind::Wildcard: {
+        const JsonTree::NodeId arr = tree.arrayAt(obj, writeKey(tree, obj, s));
+        const int n = tree.size(arr);
+        if (n == 0) {
+            // 无元素：末段直接追加值，否则新建一个元素写入
+            if (last) tree.appendValue(arr, value);
+            else writeAt(tree, tree.appendObject(arr), i + 1, value);
+            return;
+        }
+        for (int k = 0; k < n; ++k) {
+            const JsonTree::NodeId el = tree.item(arr, k);
+            if (tree.isObject(el) && writableAt(tree, el, i + 1))
+                writeAt(tree, el, i + 1, value);
+        }
+        return;
+    }
+
+    case Kind::KvMatch: {
+        const JsonTree::NodeId arr = tree.arrayAt(obj, writeKey(tree, obj, s));
+        JsonTree::NodeId target = findKvItem(tree, arr, s);
+        if (target == JsonTree::InvalidNode) {
+            // 未命中时新建 {keyField: TOKEN} 并追加
+            target = tree.appendObject(arr);
+            tree.setValue(target, s.keyField, s.token);
+        }
+        if (last) tree.setValue(target, s.valField, value);
+        else writeAt(tree, target, i + 1, value);
+        return;
+    }
+    }
+}
@@ -0,0 +1,180 @@
+﻿#pragma once
+
+#include "eapcore_global.h"
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+#include <QSharedPointer>
+#include "JsonTree.h"
+
+/**
+ * @brief 预编译 JSON 路径（不可变 AST）
+ *
+ * 映射配置中的路径（如 "body.lot_infos.lot[]{key=lot_id}.pnl_infos.pnl[*].pnl_id"）
+ * 只在首次使用时按 '.' 拆分并识别各段语法，结果按 (语法, 路径字符串) 缓存，
+ * 之后 buildPayload / parseResponse / buildMapping / buildGroupedByArrayKey /
+ * parseJson / resolvePlaceholderValue 直接复用编译结果，由统一的 read / write 求值器执行。
+ *
+ * 不同入口历史上对同一写法的解释不同（例如 "lot[]" 在映射里是键值匹配，
+ * 在占位符里是数组遍历），因此编译时需指定 Syntax，各段的查找/容错规则在编译期确定。
+ * 编译结果线程安全、可跨线程共享。
+ */
+class EAPCORE_EXPORT JsonPath
+{
+public:
+    using Ptr = QSharedPointer<const JsonPath>;
+
+    // 路径语法（决定每段的识别方式与求值规则）
+    enum Syntax {
+        Extended,   // 映射读写：name[n] / name[*] / name[]{k,v}.TOKEN / 同义键名（buildMapping、kv 写入）
+        Append,     // 请求体写入：name[] 追加并配对、已有数组续写（buildPayload 默认写法）
+        Indexed,    // 点路径 + 下标链：a.b[0][1]，body/header 常用别名（parseJson）
+        Collect,    // 占位符：name[] 遍历收集（resolvePlaceholderValue）
+        Plain       // 纯字段点路径（parseResponse）
+    };
+
+    enum class Kind {
+        Field,      // 对象字段
+        Index,      // 数组下标（name 为空时作用于当前数组）
+        Wildcard,   // 数组遍历：对每个元素求值余下路径
+        KvMatch,    // 键值数组匹配：在数组中找 keyField == token 的元素
+        AppendItem  // 写入时向数组追加/配对（name[]）
+    };
+
+    enum class Lookup {
+        Exact,          // 仅精确键名
+        Alias,          // body/header 与 request_body/request_head 互为别名
+        Synonyms,       // body/request_body/response_body、header/head/request_head/response_head 全同义
+        SectionOrSelf   // 老键值数组前缀：取到对象段则用之，否则停留在当前对象
+    };
+
+    struct Step {
+        Kind kind = Kind::Field;
+        QString raw;                  // 原始片段文本
+        QString name;                 // 字段名 / 数组名
+        QStringList alternates;       // 同义键名（按优先级，编译期展开）
+        Lookup lookup = Lookup::Exact;
+        int index = 0;                // Index：下标（可为负）
+        QString keyField;             // KvMatch：键字段
+        QString valField;             // KvMatch：值字段
+        QString token;                // KvMatch：要匹配的键值
+        bool hasToken = false;
+        bool caseInsensitive = false; // KvMatch：忽略大小写比较（老语义）
+        bool trimKey = false;         // KvMatch：元素键值先去空白再比较（parseResponse / buildPayload 老语义，parseJson 不去空白）
+        bool nullAsEmpty = false;     // Index：数组缺失/为 null 时直接得到空数组
+        bool extendArrays = false;    // Field 写入：已有数组时在最后一项上续写
+        QString indexKey;             // KvMatch：数组位置键（为空表示不可建立报文内索引）
+    };
+
+    /**
+     * @brief 单条报文内的读取作用域（键值数组索引）
+     *
+     * 同一根对象按多个映射字段读取时（parseResponse / buildMapping），每个键值数组在第一次
+     * 匹配时建立一次“键值 → 首个元素下标”的哈希索引（忽略大小写时为去空白 + case fold），
+     * 之后的匹配为 O(1)。一个作用域只能用于同一个根对象。
+     */
+    class ReadScope
+    {
+    public:
+        ReadScope() = default;
+    private:
+        friend class JsonPath;
+        int find(const Step& s, const QJsonArray& arr);
+        QHash<QString, QHash<QString, int>> indexes_;
+    };
+
+    // 老“键值对数组”写法：[body.]parameter_list.parameter_name.parameter_value.<matchKey>
+    struct LegacyKv {
+        int baseIndex = 0;
+        QString arrayName;
+        QString keyField;
+        QString valField;
+        QString matchKey;
+    };
+
+    // 分组路径：第一个 name[] / name[]{...} 段作为分组数组（buildGroupedByArrayKey）
+    struct GroupBy {
+        Ptr array;          // 分组数组自身的路径（父路径 + 数组名，含同义键名）
+        QString keyField;   // 分组键字段（如 lot_id）
+        QString nextPart;   // 分组段之后的第一段（用于判断是否为分组路径）
+        Ptr rest;           // 在每个元素下继续求值的余下路径（为空表示取整个元素）
+        QString innerKey;   // 分组结果内的字段名（余下路径的最后一个字段名，缺省 "value"）
+    };
+
+    /**
+     * @brief 编译路径（带缓存）
+     * @param path   路径字符串
+     * @param syntax 路径语法
+     * @return 编译结果，永不为空；语法非法时 isValid() 为 false
+     */
+    static Ptr compile(const QString& path, Syntax syntax);
+
+    bool isValid() const { return valid_; }
+    const QString& text() const { return text_; }
+    Syntax syntax() const { return syntax_; }
+    const QVector<Step>& steps() const { return steps_; }
+
+    // 老键值数组信息（Plain / Indexed / Append 语法下识别），未命中为 nullptr
+    const LegacyKv* legacyKv() const { return hasLegacy_ ? &legacy_ : nullptr; }
+    // 分组信息（Extended 语法且含 name[] 段时），否则为 nullptr
+    const GroupBy* groupBy() const { return group_.data(); }
+    // 是否含带 TOKEN 的键值匹配段（如 lot[]{item_id,item_value}.S001）
+    bool hasKvMatch() const { return hasKvMatch_; }
+    // Wildcard 段数量（Collect 语法下即结果嵌套层数）
+    int wildcardDepth() const { return wildcardDepth_; }
+
+    /**
+     * @brief 去掉开头的 body / request_body / response_body 段后的同语法路径
+     * @return 无此前缀时返回自身对应的编译结果
+     */
+    Ptr bodyRelative() const;
+
+    /**
+     * @brief 读取求值
+     * @param root 起始节点
+     * @return 命中的值；未命中返回 Undefined
+     */
+    QJsonValue read(const QJsonValue& root) const;
+    // 同上，键值匹配使用作用域内的索引（scope 可为 nullptr）
+    QJsonValue read(const QJsonValue& root, ReadScope* scope) const;
+
+    /**
+     * @brief 写入求值（按需创建中间对象/数组）
+     * @param root  起始对象，就地修改
+     * @param value 要写入的值
+     * @return true 表示已写入；false 表示路径无法在该结构上写入（root 不变）
+     */
+    bool write(QJsonObject& root, const QJsonValue& value) const;
+
+    /**
+     * @brief 写入求值（构建树版本，就地修改，不拷贝中间对象）
+     * @param tree  构建树
+     * @param obj   起始对象结点
+     * @param value 要写入的值
+     * @return true 表示已写入；false 表示路径无法在该结构上写入（树不变）
+     */
+    bool write(JsonTree& tree, JsonTree::NodeId obj, const QJsonValue& value) const;
+
+private:
+    JsonPath() = default;
+
+    QJsonValue readAt(const QJsonValue& node, int i, ReadScope* scope) const;
+    bool writableAt(const JsonTree& tree, JsonTree::NodeId obj, int i) const;
+    void writeAt(JsonTree& tree, JsonTree::NodeId obj, int i, const QJsonValue& value) const;
+
+    static Ptr build(const QString& path, Syntax syntax);
+
+    QString text_;
+    Syntax syntax_ = Extended;
+    bool valid_ = true;
+    QVector<Step> steps_;
+    bool hasLegacy_ = false;
+    LegacyKv legacy_;
+    QSharedPointer<const GroupBy> group_;
+    bool hasKvMatch_ = false;
+    int wildcardDepth_ = 0;
+};
@@ -0,0 +1,342 @@
+﻿#include "JsonTree.h"
+
+JsonTree::JsonTree()
+{
+    newObject(InvalidNode);
+}
+
+JsonTree::JsonTree(const QJsonObject& root)
+{
+    newNode(root, InvalidNode);
+}
+
+JsonTree::NodeId JsonTree::newNode(const QJsonValue& v, NodeId parent, int pos)
+{
+    Node n;
+    n.value = v;
+    n.parent = parent;
+    n.pos = pos;
+    nodes_.append(n);
+    return nodes_.size() - 1;
+}
+
+JsonTree::NodeId JsonTree::newObject(NodeId parent, int pos)
+{
+    Node n;
+    n.kind = Kind::Object;
+    n.parent = parent;
+    n.pos = pos;
+    nodes_.append(n);
+    return nodes_.size() - 1;
+}
+
+void JsonTree::assign(NodeId node, const QJsonValue& v)
+{
+    // 覆盖结点内容；旧子结点留在 arena 中成为不可达结点，随树一起释放
+    if (!kvIndexes_.isEmpty())
+        invalidateIndexes(node);
+    Node& n = nodes_[node];
+    n.kind = Kind::Value;
+    n.value = v;
+    n.members.clear();
+    n.items.clear();
+}
+
+void JsonTree::expand(NodeId node) const
+{
+    if (nodes_[node].kind != Kind::Value)
+        return;
+
+    const QJsonValue v = nodes_[node].value;
+    if (v.isObject()) {
+        const QJsonObject o = v.toObject();
+        QVector<QPair<int, NodeId>> members;
+        members.reserve(o.size());
+        JsonTree* self = const_cast<JsonTree*>(this);
+        for (auto it = o.begin(); it != o.end(); ++it)
+            members.append(qMakePair(self->intern(it.key()), self->newNode(it.value(), node)));
+        Node& n = nodes_[node];
+        n.kind = Kind::Object;
+        n.value = QJsonValue();
+        n.members = members;
+    }
+    else if (v.isArray()) {
+        const QJsonArray a = v.toArray();
+        QVector<NodeId> items;
+        items.reserve(a.size());
+        JsonTree* self = const_cast<JsonTree*>(this);
+        for (const QJsonValue& e : a)
+            items.append(self->newNode(e, node, items.size()));
+        Node& n = nodes_[node];
+        n.kind = Kind::Array;
+        n.value = QJsonValue();
+        n.items = items;
+    }
+}
+
+int JsonTree::intern(const QString& key)
+{
+    auto it = keyIds_.constFind(key);
+    if (it != keyIds_.constEnd())
+        return it.value();
+    const int id = keys_.size();
+    keys_.append(key);
+    keyIds_.insert(key, id);
+    return id;
+}
+
+int JsonTree::findMember(const Node& obj, int keyId) const
+{
+    for (int i = 0; i < obj.members.size(); ++i) {
+        if (obj.members[i].first == keyId)
+            return i;
+    }
+    return -1;
+}
+
+bool JsonTree::isObject(NodeId node) const
+{
+    if (node < 0 || node >= nodes_.size())
+        return false;
+    const Node& n = nodes_[node];
+    return n.kind == Kind::Object || (n.kind == Kind::Value && n.value.isObject());
+}
+
+bool JsonTree::isArray(NodeId node) const
+{
+    if (node < 0 || node >= nodes_.size())
+        return false;
+    const Node& n = nodes_[node];
+    return n.kind == Kind::Array || (n.kind == Kind::Value && n.value.isArray());
+}
+
+JsonTree::NodeId JsonTree::member(NodeId obj, const QString& key) const
+{
+    if (!isObject(obj))
+        return InvalidNode;
+    const int keyId = keyIds_.value(key, -1);
+    if (keyId < 0) {
+        // 键从未出现过：打包对象里也可能有（尚未驻留），先展开再查
+        if (nodes_[obj].kind == Kind::Value && nodes_[obj].value.toObject().contains(key)) {
+            expand(obj);
+            return member(obj, key);
+        }
+        return InvalidNode;
+    }
+    expand(obj);
+    const Node& n = nodes_[obj];
+    const int pos = findMember(n, keyId);
+    return pos < 0 ? InvalidNode : n.members[pos].second;
+}
+
+int JsonTree::size(NodeId arr) const
+{
+    if (!isArray(arr))
+        return 0;
+    const Node& n = nodes_[arr];
+    return n.kind == Kind::Array ? n.items.size() : n.value.toArray().size();
+}
+
+JsonTree::NodeId JsonTree::item(NodeId arr, int index) const
+{
+    if (!isArray(arr))
+        return InvalidNode;
+    expand(arr);
+    const Node& n = nodes_[arr];
+    return (index >= 0 && index < n.items.size()) ? n.items[index] : InvalidNode;
+}
+
+QJsonValue JsonTree::value(NodeId node) const
+{
+    if (node < 0 || node >= nodes_.size())
+        return QJsonValue(QJsonValue::Undefined);
+
+    const Node& n = nodes_[node];
+    switch (n.kind) {
+    case Kind::Value:
+        return n.value;
+    case Kind::Object:
+        return toObject(node);
+    case Kind::Array: {
+        QJsonArray a;
+        for (NodeId c : n.items)
+            a.append(value(c));
+        return a;
+    }
+    }
+    return QJsonValue();
+}
+
+QJsonObject JsonTree::toObject(NodeId node) const
+{
+    if (node < 0 || node >= nodes_.size())
+        return QJsonObject();
+
+    const Node& n = nodes_[node];
+    if (n.kind == Kind::Value)
+        return n.value.toObject();
+    if (n.kind != Kind::Object)
+        return QJsonObject();
+
+    QJsonObject o;
+    for (const auto& m : n.members)
+        o.insert(keys_[m.first], value(m.second));
+    return o;
+}
+
+JsonTree::NodeId JsonTree::setValue(NodeId obj, const QString& key, const QJsonValue& v)
+{
+    expand(obj);
+    const int keyId = intern(key);
+    const int pos = findMember(nodes_[obj], keyId);
+    if (!kvIndexes_.isEmpty())
+        noteMemberWrite(obj, keyId, pos >= 0 ? nodes_[obj].members[pos].second : InvalidNode, v);
+    if (pos >= 0) {
+        const NodeId child = nodes_[obj].members[pos].second;
+        assign(child, v);
+        return child;
+    }
+    const NodeId child = newNode(v, obj);
+    nodes_[obj].members.append(qMakePair(keyId, child));
+    return child;
+}
+
+JsonTree::NodeId JsonTree::objectAt(NodeId obj, const QString& key)
+{
+    NodeId child = member(obj, key);
+    if (child == InvalidNode || !isObject(child))
+        child = setValue(obj, key, QJsonObject());
+    expand(child);
+    return child;
+}
+
+JsonTree::NodeId JsonTree::arrayAt(NodeId obj, const QString& key)
+{
+    NodeId child = member(obj, key);
+    if (child == InvalidNode || !isArray(child))
+        child = setValue(obj, key, QJsonArray());
+    expand(child);
+    return child;
+}
+
+JsonTree::NodeId JsonTree::appendValue(NodeId arr, const QJsonValue& v)
+{
+    expand(arr);
+    const NodeId child = newNode(v, arr, nodes_[arr].items.size());
+    nodes_[arr].items.append(child);
+    return child;
+}
+
+JsonTree::NodeId JsonTree::appendObject(NodeId arr)
+{
+    expand(arr);
+    const NodeId child = newObject(arr, nodes_[arr].items.size());
+    nodes_[arr].items.append(child);
+    return child;
+}
+
+void JsonTree::setItem(NodeId arr, int index, const QJsonValue& v)
+{
+    const NodeId child = item(arr, index);
+    if (child != InvalidNode)
+        assign(child, v);
+}
+
+JsonTree::NodeId JsonTree::objectItem(NodeId arr, int index)
+{
+    const NodeId child = item(arr, index);
+    if (child == InvalidNode)
+        return InvalidNode;
+    if (!isObject(child))
+        assign(child, QJsonObject());
+    expand(child);
+    return child;
+}
+
+QString JsonTree::foldKey(const QString& keyVal, bool caseInsensitive)
+{
+    return caseInsensitive ? keyVal.trimmed().toCaseFolded() : keyVal;
+}
+
+JsonTree::NodeId JsonTree::findByKey(NodeId arr, const QString& keyField, const QString& key, bool caseInsensitive) const
+{
+    if (!isArray(arr))
+        return InvalidNode;
+    expand(arr);
+
+    const int keyId = const_cast<JsonTree*>(this)->intern(keyField);
+    KvIndex* idx = nullptr;
+    for (KvIndex& k : kvIndexes_) {
+        if (k.arr == arr && k.keyId == keyId && k.caseInsensitive == caseInsensitive) {
+            idx = &k;
+            break;
+        }
+    }
+    if (!idx) {
+        KvIndex k;
+        k.arr = arr;
+        k.keyId = keyId;
+        k.caseInsensitive = caseInsensitive;
+        kvIndexes_.append(k);
+        idx = &kvIndexes_.last();
+    }
+
+    // 增量补入上次建立索引之后追加的元素（保留首个命中，与线性扫描结果一致）
+    const QVector<NodeId> items = nodes_[arr].items;  // 查找成员可能展开结点、扩张 arena，这里持有副本
+    for (int p = idx->indexed; p < items.size(); ++p) {
+        const NodeId item = items[p];
+        if (!isObject(item))
+            continue;
+        const QString k = foldKey(value(member(item, keyField)).toString(), caseInsensitive);
+        if (!idx->first.contains(k))
+            idx->first.insert(k, item);
+    }
+    idx->indexed = items.size();
+
+    // 查询值不去空白：老语义下只有元素键值做 trimmed 比较
+    return idx->first.value(caseInsensitive ? key.toCaseFolded() : key, InvalidNode);
+}
+
+void JsonTree::invalidateIndexes(NodeId node)
+{
+    // 数组本身被覆盖：删除其索引；已索引的元素被覆盖：所在数组的索引重建
+    const NodeId parent = nodes_[node].parent;
+    const int pos = nodes_[node].pos;
+    for (int i = kvIndexes_.size() - 1; i >= 0; --i) {
+        KvIndex& k = kvIndexes_[i];
+        if (k.arr == node) {
+            kvIndexes_.removeAt(i);
+        }
+        else if (k.arr == parent && pos >= 0 && pos < k.indexed) {
+            k.first.clear();
+            k.indexed = 0;
+        }
+    }
+}
+
+void JsonTree::noteMemberWrite(NodeId obj, int keyId, NodeId oldChild, const QJsonValue& newValue)
+{
+    const NodeId parent = nodes_[obj].parent;
+    const int pos = nodes_[obj].pos;
+    if (parent == InvalidNode || pos < 0)
+        return;
+
+    for (KvIndex& k : kvIndexes_) {
+        if (k.arr != parent || k.keyId != keyId || pos >= k.indexed)
+            continue;
+        const QString oldKey = foldKey(value(oldChild).toString(), k.caseInsensitive);
+        const QString newKey = foldKey(newValue.toString(), k.caseInsensitive);
+        if (oldKey == newKey)
+            continue;
+        if (k.first.value(oldKey, InvalidNode) == obj) {
+            // 该元素原本是旧键值的首个命中，旧键值的下一个命中未知，整体重建
+            k.first.clear();
+            k.indexed = 0;
+            continue;
+        }
+        // 新键值：仅当比现有首个命中更靠前时替换
+        const auto it = k.first.constFind(newKey);
+        if (it == k.first.constEnd() || nodes_[it.value()].pos > pos)
+            k.first.insert(newKey, obj);
+    }
+}
@@ -0,0 +1,113 @@
+﻿#pragma once
+
+#include "eapcore_global.h"
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+
+/**
+ * @brief 可就地修改的 JSON 构建树
+ *
+ * QJsonObject 是隐式共享的值类型，按路径逐字段写入时每一层都要“取出子对象拷贝 → 递归修改 →
+ * 写回”，m 个字段、深度 d 的报文需要 O(m × d × 对象大小) 的拷贝与 detach。
+ * JsonTree 把结点放在一个数组（arena）中，用下标引用，键名在树内驻留为整数，
+ * 写入时直接修改目标结点；装配完成后调用 toObject() 一次性转换为 QJsonObject。
+ *
+ * 传入的已有 QJsonValue（如预置 header、@raw 注入的整块对象）以“打包”结点保存，
+ * 只有写入需要下钻时才浅展开一层，未被触及的子树在最终转换时原样复用。
+ *
+ * 非线程安全；一棵树只用于一次报文装配。
+ */
+class EAPCORE_EXPORT JsonTree
+{
+public:
+    using NodeId = int;
+    static constexpr NodeId InvalidNode = -1;
+
+    JsonTree();                              // 根为空对象
+    explicit JsonTree(const QJsonObject& root);
+
+    NodeId root() const { return 0; }
+
+    // ---------- 查询 ----------
+    bool isObject(NodeId node) const;
+    bool isArray(NodeId node) const;
+    // 对象成员（不存在或 obj 非对象时返回 InvalidNode）
+    NodeId member(NodeId obj, const QString& key) const;
+    bool contains(NodeId obj, const QString& key) const { return member(obj, key) != InvalidNode; }
+    // 数组长度 / 元素（非数组时长度为 0）
+    int size(NodeId arr) const;
+    NodeId item(NodeId arr, int index) const;
+    // 物化结点为 QJsonValue（InvalidNode 为 Undefined）
+    QJsonValue value(NodeId node) const;
+    /**
+     * @brief 键值数组查找：返回 arr 中第一个 keyField 值等于 key 的对象元素
+     * @param caseInsensitive true 时元素键值去空白后忽略大小写比较（老键值数组语义）
+     * @return 未命中返回 InvalidNode
+     *
+     * 每个 (数组, 键字段) 在第一次查找时建立哈希索引，之后追加的元素增量补入，
+     * 键字段被改写时索引自动失效重建；同一报文的多次查找/写入均为 O(1)。
+     */
+    NodeId findByKey(NodeId arr, const QString& keyField, const QString& key, bool caseInsensitive) const;
+
+    // ---------- 修改（obj / arr 需为对象 / 数组结点） ----------
+    // 写入（覆盖）成员，返回成员结点
+    NodeId setValue(NodeId obj, const QString& key, const QJsonValue& v);
+    // 取成员对象；不存在或不是对象时以空对象替换
+    NodeId objectAt(NodeId obj, const QString& key);
+    // 取成员数组；不存在或不是数组时以空数组替换
+    NodeId arrayAt(NodeId obj, const QString& key);
+    // 追加元素 / 追加空对象
+    NodeId appendValue(NodeId arr, const QJsonValue& v);
+    NodeId appendObject(NodeId arr);
+    // 覆盖第 index 个元素
+    void setItem(NodeId arr, int index, const QJsonValue& v);
+    // 取第 index 个元素对象；不是对象时以空对象替换
+    NodeId objectItem(NodeId arr, int index);
+
+    // ---------- 转换 ----------
+    QJsonObject toObject() const { return toObject(root()); }
+    QJsonObject toObject(NodeId node) const;
+
+private:
+    enum class Kind { Value, Object, Array };
+
+    struct Node {
+        Kind kind = Kind::Value;
+        QJsonValue value;                      // Kind::Value：标量或尚未展开的对象/数组
+        QVector<QPair<int, NodeId>> members;   // Kind::Object：(键 id, 结点)
+        QVector<NodeId> items;                 // Kind::Array
+        NodeId parent = InvalidNode;           // 所在容器
+        int pos = -1;                          // 作为数组元素时的下标
+    };
+
+    // 键值数组索引：键字段值（折叠后）-> 首个命中元素
+    struct KvIndex {
+        NodeId arr = InvalidNode;
+        int keyId = -1;
+        bool caseInsensitive = false;
+        int indexed = 0;                       // 已纳入索引的元素个数（之后的元素在查找时补入）
+        QHash<QString, NodeId> first;
+    };
+
+    NodeId newNode(const QJsonValue& v, NodeId parent, int pos = -1);
+    NodeId newObject(NodeId parent, int pos = -1);
+    void assign(NodeId node, const QJsonValue& v);
+    void expand(NodeId node) const;            // 打包的对象/数组浅展开一层
+    int intern(const QString& key);
+    int findMember(const Node& obj, int keyId) const;
+    static QString foldKey(const QString& keyVal, bool caseInsensitive);
+    // 结点被整体覆盖 / 对象成员被写入时维护键值数组索引
+    void invalidateIndexes(NodeId node);
+    void noteMemberWrite(NodeId obj, int keyId, NodeId oldChild, const QJsonValue& newValue);
+
+    // 展开只改变表示，不改变逻辑内容，因此允许在 const 查询中进行
+    mutable QVector<Node> nodes_;
+    QVector<QString> keys_;
+    QHash<QString, int> keyIds_;
+    mutable QVector<KvIndex> kvIndexes_;  // 每棵树通常只有少数几个
+};
@@ -0,0 +1,206 @@
+﻿#include "JsonWriter.h"
+
+#include <QLocale>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// 4 个 UTF-16 码元一组：全部为无需转义的可见 ASCII（0x20..0x7F，且非 '"' / '\\'）时返回 true
+inline bool plainAscii4(const ushort* p)
+{
+    quint64 w;
+    std::memcpy(&w, p, sizeof(w));
+    const quint64 lanes = 0x0001000100010001ULL;
+    const quint64 highs = 0x8000800080008000ULL;
+    if (w & 0xFF80FF80FF80FF80ULL) return false;             // 存在 >= 0x80 的码元
+    if ((w - 0x0020 * lanes) & ~w & highs) return false;      // 存在 < 0x20 的控制字符
+    const quint64 q = w ^ (0x0022 * lanes);                   // '"'
+    if ((q - lanes) & ~q & highs) return false;
+    const quint64 b = w ^ (0x005C * lanes);                   // '\\'
+    if ((b - lanes) & ~b & highs) return false;
+    return true;
+}
+
+const char kHex[] = "0123456789abcdef";
+
+} // namespace
+
+JsonWriter::JsonWriter(int reserveBytes)
+    : reserve_(reserveBytes)
+{
+    buf_.reserve(reserve_);
+}
+
+void JsonWriter::clear()
+{
+    // reserve 过的 QByteArray 在 resize(0) 时保留容量
+    buf_.resize(0);
+}
+
+QByteArray JsonWriter::take()
+{
+    QByteArray out = buf_;
+    buf_ = QByteArray();
+    buf_.reserve(reserve_);
+    return out;
+}
+
+QByteArray JsonWriter::toJson(const QJsonObject& obj)
+{
+    JsonWriter w;
+    w.write(obj);
+    return w.take();
+}
+
+void JsonWriter::write(const QJsonObject& obj)
+{
+    buf_.append('{');
+    bool first = true;
+    for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+        if (!first) buf_.append(',');
+        first = false;
+        writeString(it.key());
+        buf_.append(':');
+        write(it.value());
+    }
+    buf_.append('}');
+}
+
+void JsonWriter::write(const QJsonArray& arr)
+{
+    buf_.append('[');
+    bool first = true;
+    for (const QJsonValue& v : arr) {
+        if (!first) buf_.append(',');
+        first = false;
+        write(v);
+    }
+    buf_.append(']');
+}
+
+void JsonWriter::write(const QJsonValue& v)
+{
+    switch (v.type()) {
+    case QJsonValue::Bool:
+        if (v.toBool()) buf_.append("true", 4);
+        else buf_.append("false", 5);
+        break;
+    case QJsonValue::Double:
+        writeNumber(v.toDouble());
+        break;
+    case QJsonValue::String:
+        writeString(v.toString());
+        break;
+    case QJsonValue::Array:
+        write(v.toArray());
+        break;
+    case QJsonValue::Object:
+        write(v.toObject());
+        break;
+    case QJsonValue::Null:
+    case QJsonValue::Undefined:
+    default:
+        buf_.append("null", 4);
+        break;
+    }
+}
+
+void JsonWriter::writeNumber(double d)
+{
+    if (!std::isfinite(d)) {
+        buf_.append("null", 4);
+        return;
+    }
+    // 快速路径：|v| < 1e5 的整数（-0 除外），'g' 最短表示必为纯整数，直接写出；
+    // 其余与 QJsonDocument 相同交给 QByteArray::number（大整数会是 1e+06 这样的指数形式）
+    if (d == std::floor(d) && std::fabs(d) < 100000.0 && !(d == 0.0 && std::signbit(d))) {
+        char tmp[8];
+        char* end = tmp + sizeof(tmp);
+        char* p = end;
+        qint64 n = static_cast<qint64>(d);
+        const bool neg = n < 0;
+        quint64 u = neg ? quint64(-n) : quint64(n);
+        do {
+            *--p = char('0' + u % 10);
+            u /= 10;
+        } while (u);
+        if (neg) *--p = '-';
+        buf_.append(p, int(end - p));
+        return;
+    }
+    buf_.append(QByteArray::number(d, 'g', QLocale::FloatingPointShortest));
+}
+
+void JsonWriter::writeString(const QString& s)
+{
+    // 先在栈上小块缓冲中编码，写满再整体追加，避免逐字节 append
+    char chunk[512];
+    int n = 0;
+    auto flush = [&]() {
+        buf_.append(chunk, n);
+        n = 0;
+    };
+
+    buf_.append('"');
+    const ushort* p = s.utf16();
+    const ushort* end = p + s.size();
+    while (p < end) {
+        if (n > int(sizeof(chunk)) - 16) flush();
+
+        // 快速路径：4 个码元一组的纯 ASCII
+        if (end - p >= 4 && plainAscii4(p)) {
+            chunk[n++] = char(p[0]);
+            chunk[n++] = char(p[1]);
+            chunk[n++] = char(p[2]);
+            chunk[n++] = char(p[3]);
+            p += 4;
+            continue;
+        }
+
+        const ushort c = *p++;
+        if (c < 0x80) {
+            switch (c) {
+            case '"':  chunk[n++] = '\\'; chunk[n++] = '"';  break;
+            case '\\': chunk[n++] = '\\'; chunk[n++] = '\\'; break;
+            case '\b': chunk[n++] = '\\'; chunk[n++] = 'b';  break;
+            case '\f': chunk[n++] = '\\'; chunk[n++] = 'f';  break;
+            case '\n': chunk[n++] = '\\'; chunk[n++] = 'n';  break;
+            case '\r': chunk[n++] = '\\'; chunk[n++] = 'r';  break;
+            case '\t': chunk[n++] = '\\'; chunk[n++] = 't';  break;
+            default:
+                if (c < 0x20) {
+                    chunk[n++] = '\\'; chunk[n++] = 'u'; chunk[n++] = '0'; chunk[n++] = '0';
+                    chunk[n++] = kHex[c >> 4];
+                    chunk[n++] = kHex[c & 0xF];
+                }
+                else {
+                    chunk[n++] = char(c);
+                }
+                break;
+            }
+        }
+        else if (c < 0x800) {
+            chunk[n++] = char(0xC0 | (c >> 6));
+            chunk[n++] = char(0x80 | (c & 0x3F));
+        }
+        else if (QChar::isHighSurrogate(c) && p < end && QChar::isLowSurrogate(*p)) {
+            const uint cp = QChar::surrogateToUcs4(c, *p++);
+            chunk[n++] = char(0xF0 | (cp >> 18));
+            chunk[n++] = char(0x80 | ((cp >> 12) & 0x3F));
+            chunk[n++] = char(0x80 | ((cp >> 6) & 0x3F));
+            chunk[n++] = char(0x80 | (cp & 0x3F));
+        }
+        else if (QChar::isSurrogate(c)) {
+            // 孤立代理项：输出 U+FFFD
+            chunk[n++] = char(0xEF); chunk[n++] = char(0xBF); chunk[n++] = char(0xBD);
+        }
+        else {
+            chunk[n++] = char(0xE0 | (c >> 12));
+            chunk[n++] = char(0x80 | ((c >> 6) & 0x3F));
+            chunk[n++] = char(0x80 | (c & 0x3F));
+        }
+    }
+    chunk[n++] = '"';
+    flush();
+}
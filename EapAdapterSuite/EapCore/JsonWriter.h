@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include "eapcore_global.h"
+#include <QByteArray>
+#include <QString>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonValue>
+
+/**
+ * @brief 紧凑 UTF-8 JSON 写出器（直接追加到可复用缓冲区）
+ *
+ * 替代 QJsonDocument(obj).toJson(Compact)：不经过 QJsonDocument，字符串直接从 QString 的
+ * UTF-16 数据转义并编码为 UTF-8，纯 ASCII 且无需转义的片段按 4 个字符一组批量判定与写出。
+ * clear() 保留已分配容量，长期持有（如每个 HTTP 工作线程一个）时不再反复分配。
+ *
+ * 输出与 Qt 5 紧凑格式逐字节一致；数字与 QJsonDocument 相同按 'g' 最短表示写出
+ * （1000000 为 1e+06，-0 为 -0），只有确定不会出现指数形式的小整数走快速路径。
+ * 非线程安全。
+ */
+class EAPCORE_EXPORT JsonWriter
+{
+public:
+    explicit JsonWriter(int reserveBytes = 1024);
+
+    // 清空内容（保留容量）
+    void clear();
+
+    void write(const QJsonObject& obj);
+    void write(const QJsonArray& arr);
+    void write(const QJsonValue& v);
+
+    const QByteArray& buffer() const { return buf_; }
+    const char* data() const { return buf_.constData(); }
+    int size() const { return buf_.size(); }
+
+    // 取走结果（缓冲区随之交出，之后写入重新分配）
+    QByteArray take();
+
+    // 便利接口：一次性序列化
+    static QByteArray toJson(const QJsonObject& obj);
+
+private:
+    void writeString(const QString& s);
+    void writeNumber(double d);
+
+    QByteArray buf_;
+    int reserve_;
+};
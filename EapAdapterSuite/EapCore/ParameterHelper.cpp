@@ -4,22 +4,20 @@
 #include <QJsonParseError>
 #include <QDebug>
 #include <QJsonValue>
-#include <QWriteLocker>
-#include <QReadLocker>
 #include <QJsonArray>
-QVariantMap ParameterHelper::s_params; // 全局变量定义--获取默认参数配置
+#include <atomic>
+std::shared_ptr<const ParameterHelper::Snapshot> ParameterHelper::s_snapshot; // 全局变量定义--默认参数配置快照
 
-// 返回对单例锁的引用（函数局部静态，C++11 保证线程安全的初始化）
-QReadWriteLock& ParameterHelper::lock()
+// 取当前快照：读者只持有一份引用计数，写者（loadDefaultParam）整体替换，旧快照在最后一个读者释放后析构
+std::shared_ptr<const ParameterHelper::Snapshot> ParameterHelper::snapshot()
 {
-    static QReadWriteLock theLock;
-    return theLock;
+    return std::atomic_load(&s_snapshot);
 }
 
 /**
  * @brief 从 JSON 文件加载默认参数，并刷新全局参数缓存
  * @param filepath 默认参数配置文件路径（JSON 格式，顶层为对象）
- * @return true 表示加载并解析成功，且已用写锁安全更新 s_params；
+ * @return true 表示加载并解析成功，且已原子替换默认参数快照；
  *         false 表示文件打开失败、JSON 解析失败或顶层结构非法
  * 
  * 加载默认参数 /config/eap/default_params.json
@@ -43,17 +41,21 @@ bool ParameterHelper::loadDefaultParam(const QString& filepath)
         return false;
     }
 
-    QVariantMap map = doc.toVariant().toMap();
+    // 在新快照上预先把每个接口的默认参数转换为 QJsonObject，合并时直接共享插入
+    auto snap = std::make_shared<Snapshot>();
+    snap->params = doc.toVariant().toMap();
+    for (auto it = snap->params.constBegin(); it != snap->params.constEnd(); ++it) {
+        if (it.value().type() == QVariant::Map)
+            snap->jsonDefaults.insert(it.key(), QJsonObject::fromVariantMap(it.value().toMap()));
+    }
 
-    // 写锁保护
-    QWriteLocker locker(&lock());
-    s_params.swap(map);
+    std::atomic_store(&s_snapshot, std::shared_ptr<const Snapshot>(std::move(snap)));
     return true;
 }
 
 /**
  * @brief 从全局默认参数表中获取指定接口下的参数值
- * @param interfaceName 接口名（如 "UploadPanelData"），对应 s_params 顶层的键
+ * @param interfaceName 接口名（如 "UploadPanelData"），对应默认参数配置顶层的键
  * @param keyName       参数名：
  *                      - 若为空字符串，则返回该接口对应的整块配置（通常是 QVariantMap）；
  *                      - 否则返回该接口下 keyName 对应的参数值。
@@ -62,9 +64,11 @@ bool ParameterHelper::loadDefaultParam(const QString& filepath)
  */
 QVariant ParameterHelper::getParam(const QString& interfaceName, const QString& keyName)
 {
-    QReadLocker locker(&lock());
+    const auto snap = snapshot();
+    if (!snap)
+        return QVariant();
 
-    QVariant ifaceVar = s_params.value(interfaceName);
+    const QVariant ifaceVar = snap->params.value(interfaceName);
     if (!ifaceVar.isValid())
         return QVariant();
 
@@ -82,7 +86,7 @@ QVariant ParameterHelper::getParam(const QString& interfaceName, const QString&
 /**
  * @brief 将指定接口的某个默认参数合并到输入 map 中（仅在当前值为空时才补默认值）
  * @param inputMap      目标参数表，函数会在其中按需插入默认值
- * @param interfaceName 接口名，用于从全局默认参数表 s_params 中查找对应配置
+ * @param interfaceName 接口名，用于从全局默认参数表中查找对应配置
  * @param keyName       需要合并的字段名
  */
 void ParameterHelper::mergeTo(QVariantMap& inputMap, const QString& interfaceName, const QString& keyName)
@@ -102,12 +106,14 @@ void ParameterHelper::mergeTo(QVariantMap& inputMap, const QString& interfaceNam
 /**
  * @brief 将指定接口的全部默认参数批量合并到输入 map 中
  * @param inputMap      目标参数表，函数会在其中按需插入多个默认字段
- * @param interfaceName 接口名，对应 s_params 顶层的键，用于获取该接口的默认配置
+ * @param interfaceName 接口名，对应默认参数配置顶层的键，用于获取该接口的默认配置
  */
 void ParameterHelper::mergeAllTo(QVariantMap& inputMap, const QString& interfaceName)
 {
-    QReadLocker locker(&lock());
-    QVariant ifaceVar = s_params.value(interfaceName);
+    const auto snap = snapshot();
+    if (!snap)
+        return;
+    const QVariant ifaceVar = snap->params.value(interfaceName);
     if (!ifaceVar.isValid() || ifaceVar.type() != QVariant::Map)
         return;
 
@@ -221,11 +227,33 @@ bool ParameterHelper::isEmptyVariant(const QVariant& v)
 
 // ---------- QJsonObject 版本的合并接口 ----------
 
-// 从默认参数（s_params）合并单个 key 到 QJsonObject（当不存在或存在但无值时插入）
 /**
- * @brief 从全局默认参数表（s_params）中合并单个字段到 QJsonObject
+ * @brief 判断一个 JSON 值是否可视为“空值”
+ * @param v 待检查的 QJsonValue
+ * @return 与 isEmptyVariant(v.toVariant()) 相同：undefined/null、空白字符串、空数组、空对象为“空”
+ */
+bool ParameterHelper::isEmptyJson(const QJsonValue& v)
+{
+    switch (v.type()) {
+    case QJsonValue::Undefined:
+    case QJsonValue::Null:
+        return true;
+    case QJsonValue::String:
+        return v.toString().trimmed().isEmpty();
+    case QJsonValue::Array:
+        return v.toArray().isEmpty();
+    case QJsonValue::Object:
+        return v.toObject().isEmpty();
+    default:
+        return false;
+    }
+}
+
+// 从默认参数合并单个 key 到 QJsonObject（当不存在或存在但无值时插入）
+/**
+ * @brief 从全局默认参数表中合并单个字段到 QJsonObject
  * @param inputMap      目标 JSON 对象，将在其中按需插入 keyName 对应的默认值
- * @param interfaceName 接口名，用于从 s_params 中获取该接口下的默认配置
+ * @param interfaceName 接口名，用于从默认参数表中获取该接口下的默认配置
  * @param keyName       需要合并的字段名
  */
 void ParameterHelper::JsonmergeTo(QJsonObject& inputMap, const QString& interfaceName, const QString& keyName)
@@ -234,25 +262,23 @@ void ParameterHelper::JsonmergeTo(QJsonObject& inputMap, const QString& interfac
         return;
 
     // 检查现有值：存在且非空则跳过
-    if (inputMap.contains(keyName)) {
-        QJsonValue ev = inputMap.value(keyName);
-        QVariant existingVar = ev.toVariant();
-        if (existingVar.isValid() && !isEmptyVariant(existingVar))
-            return;
-    }
-     
-    QVariant def = getParam(interfaceName, keyName); // 从全局默认参数表中获取指定接口下的参数值
-    if (!def.isValid())
+    if (inputMap.contains(keyName) && !isEmptyJson(inputMap.value(keyName)))
+        return;
+
+    const auto snap = snapshot();
+    if (!snap)
+        return;
+    const auto it = snap->jsonDefaults.constFind(interfaceName);
+    if (it == snap->jsonDefaults.constEnd() || !it.value().contains(keyName))
         return;
 
-    QJsonValue jv = QJsonValue::fromVariant(def);
-    inputMap.insert(keyName, jv);
+    inputMap.insert(keyName, it.value().value(keyName));
 }
 
 /**
  * @brief 将指定接口的全部默认参数批量合并到 QJsonObject 中
  * @param inputMap      目标 JSON 对象，将在其中按需插入多个默认字段
- * @param interfaceName 接口名，对应 s_params 顶层键，用于获取该接口的默认配置
+ * @param interfaceName 接口名，对应默认参数配置顶层键，用于获取该接口的默认配置
  * 
  * 使用：
  *  默认参数表：
@@ -281,21 +307,43 @@ void ParameterHelper::JsonmergeTo(QJsonObject& inputMap, const QString& interfac
  */
 void ParameterHelper::JsonmergeAllTo(QJsonObject& inputMap, const QString& interfaceName)
 {
-    QReadLocker locker(&lock());
-    QVariant ifaceVar = s_params.value(interfaceName);
-    if (!ifaceVar.isValid() || ifaceVar.type() != QVariant::Map)
+    const auto snap = snapshot();
+    if (!snap)
+        return;
+    const auto defs = snap->jsonDefaults.constFind(interfaceName);
+    if (defs == snap->jsonDefaults.constEnd())
         return;
 
-    QVariantMap ifaceMap = ifaceVar.toMap();
-    for (auto it = ifaceMap.constBegin(); it != ifaceMap.constEnd(); ++it) {
-        const QString key = it.key();
-        if (inputMap.contains(key)) {
-            QVariant existingVar = inputMap.value(key).toVariant();
-            if (existingVar.isValid() && !isEmptyVariant(existingVar))
-                continue;
-        }
-        QJsonValue jv = QJsonValue::fromVariant(it.value());
-        inputMap.insert(key, jv);
+    const QJsonObject& ifaceDefaults = defs.value();
+    for (auto it = ifaceDefaults.constBegin(); it != ifaceDefaults.constEnd(); ++it) {
+        const auto existing = inputMap.constFind(it.key());
+        if (existing != inputMap.constEnd() && !isEmptyJson(existing.value()))
+            continue;
+        inputMap.insert(it.key(), it.value());
+    }
+}
+
+/**
+ * @brief JsonmergeAllTo 的构建树版本：在对象结点上就地补齐缺失/空字段
+ * @param tree          构建树
+ * @param obj           目标对象结点
+ * @param interfaceName 接口名
+ */
+void ParameterHelper::JsonmergeAllTo(JsonTree& tree, JsonTree::NodeId obj, const QString& interfaceName)
+{
+    const auto snap = snapshot();
+    if (!snap)
+        return;
+    const auto defs = snap->jsonDefaults.constFind(interfaceName);
+    if (defs == snap->jsonDefaults.constEnd())
+        return;
+
+    const QJsonObject& ifaceDefaults = defs.value();
+    for (auto it = ifaceDefaults.constBegin(); it != ifaceDefaults.constEnd(); ++it) {
+        const JsonTree::NodeId existing = tree.member(obj, it.key());
+        if (existing != JsonTree::InvalidNode && !isEmptyJson(tree.value(existing)))
+            continue;
+        tree.setValue(obj, it.key(), it.value());
     }
 }
 
@@ -353,17 +401,27 @@ void ParameterHelper::JsonmergeAllToFromJson(QJsonObject& inputMap, const QJsonO
 }
 
 // 递归应用：在 object 上根据 parts[idx..] 应用 value
-static void applyPathToObject(QJsonObject& obj, const QStringList& parts, int idx, const QJsonValue& value);
+static void applyPathToObject(JsonTree& tree, JsonTree::NodeId obj, const QStringList& parts, int idx, const QJsonValue& value);
+
+// 非对象元素转换为对象，原值保留到 "_value"
+static JsonTree::NodeId wrapAsObject(JsonTree& tree, JsonTree::NodeId arr, int i)
+{
+    const QJsonValue old = tree.value(tree.item(arr, i));
+    const JsonTree::NodeId elObj = tree.objectItem(arr, i);
+    tree.setValue(elObj, QStringLiteral("_value"), old);
+    return elObj;
+}
 
 // 递归应用：在 array 上根据 parts[idx..] 应用 value
 /**
- * @brief 递归地在 QJsonArray 上按照给定路径片段应用写入值
+ * @brief 递归地在构建树的数组结点上按照给定路径片段就地写入值
+ * @param tree  构建树
  * @param arr   当前要操作的数组结点，对应 parts[idx-1] 所指向的容器
  * @param parts 预先按 '.' 拆分好的路径片段列表
  * @param idx   当前要处理的路径片段下标（下一段路径为 parts[idx]）
  * @param value 最终要写入的值（可为标量或数组）
  */
-static void applyPathToArray(QJsonArray& arr, const QStringList& parts, int idx, const QJsonValue& value)
+static void applyPathToArray(JsonTree& tree, JsonTree::NodeId arr, const QStringList& parts, int idx, const QJsonValue& value)
 {
     // arr corresponds to the container referenced by parts[idx-1]
     // next part is parts[idx]
@@ -371,124 +429,91 @@ static void applyPathToArray(QJsonArray& arr, const QStringList& parts, int idx,
 
     // 如果下一部分是最后一段（final key），则对数组的行为取决于 value 类型
     if (idx == parts.size() - 1) {
-        const QString finalKey = parts[idx];
+        const QString& finalKey = parts[idx];
         if (value.isArray()) {
             // append new objects for each element in value array: { finalKey: elem }
-            for (const QJsonValue& elem : value.toArray()) {
-                QJsonObject newObj;
-                newObj.insert(finalKey, elem);
-                arr.append(newObj);
-            }
+            for (const QJsonValue& elem : value.toArray())
+                tree.setValue(tree.appendObject(arr), finalKey, elem);
+        }
+        else if (tree.size(arr) == 0) {
+            // 对于单值：若数组为空则追加新对象
+            tree.setValue(tree.appendObject(arr), finalKey, value);
         }
         else {
-            // 对于单值：设置每个已有元素的 finalKey，若数组为空则追加新对象
-            if (arr.isEmpty()) {
-                QJsonObject newObj;
-                newObj.insert(finalKey, value);
-                arr.append(newObj);
-            }
-            else {
-                for (int i = 0; i < arr.size(); ++i) {
-                    QJsonValue item = arr.at(i);
-                    QJsonObject itemObj;
-                    if (item.isObject()) {
-                        itemObj = item.toObject();
-                    }
-                    else {
-                        // 保留原值到 "_value"（可选），并转换为 object
-                        itemObj = QJsonObject();
-                        itemObj.insert("_value", item);
-                    }
-                    itemObj.insert(finalKey, value);
-                    arr[i] = itemObj;
-                }
+            // 否则设置每个已有元素的 finalKey（非对象元素保留原值到 "_value" 并转换为 object）
+            const int n = tree.size(arr);
+            for (int i = 0; i < n; ++i) {
+                const JsonTree::NodeId item = tree.item(arr, i);
+                const JsonTree::NodeId itemObj = tree.isObject(item) ? item : wrapAsObject(tree, arr, i);
+                tree.setValue(itemObj, finalKey, value);
             }
         }
         return;
     }
 
     // 否则需要对数组中的每个元素递归处理下一段路径
-    const QString nextKey = parts[idx];
-    for (int i = 0; i < arr.size(); ++i) {
-        QJsonValue element = arr.at(i);
-        if (element.isObject()) {
-            QJsonObject elObj = element.toObject();
-            applyPathToObject(elObj, parts, idx, value); // 部分 idx 属于对象的 key
-            arr[i] = elObj;
+    const int n = tree.size(arr);
+    for (int i = 0; i < n; ++i) {
+        const JsonTree::NodeId element = tree.item(arr, i);
+        if (tree.isObject(element)) {
+            applyPathToObject(tree, element, parts, idx, value); // 部分 idx 属于对象的 key
         }
-        else if (element.isArray()) {
-            QJsonArray elArr = element.toArray();
-            applyPathToArray(elArr, parts, idx, value);
-            arr[i] = elArr;
+        else if (tree.isArray(element)) {
+            applyPathToArray(tree, element, parts, idx, value);
         }
         else {
             // 非对象非数组：将其转换为对象并继续递归
-            QJsonObject elObj;
-            elObj.insert("_value", element);
-            applyPathToObject(elObj, parts, idx, value);
-            arr[i] = elObj;
+            applyPathToObject(tree, wrapAsObject(tree, arr, i), parts, idx, value);
         }
     }
 }
 
 /**
- * @brief 按路径片段递归地向 QJsonObject 中写入值（对象节点版本）
- * @param obj   当前要操作的 JSON 对象结点
+ * @brief 按路径片段递归地向构建树的对象结点中就地写入值
+ * @param tree  构建树
+ * @param obj   当前要操作的对象结点
  * @param parts 预先按 '.' 拆分好的路径片段列表
  * @param idx   当前处理的路径片段下标（parts[idx] 为当前 key）
  * @param value 最终要写入的值（可为标量或数组）
  */
-static void applyPathToObject(QJsonObject& obj, const QStringList& parts, int idx, const QJsonValue& value)
+static void applyPathToObject(JsonTree& tree, JsonTree::NodeId obj, const QStringList& parts, int idx, const QJsonValue& value)
 {
     if (idx >= parts.size()) return;
 
-    QString key = parts[idx];
+    const QString& key = parts[idx];
 
     // 如果这是最后一段，直接写入 obj[key]（覆盖或创建）
     if (idx == parts.size() - 1) {
-        obj.insert(key, value);
+        tree.setValue(obj, key, value);
         return;
     }
 
     // 下一个节点索引
-    int nextIdx = idx + 1;
+    const int nextIdx = idx + 1;
 
-    QJsonValue child = obj.value(key);
+    const JsonTree::NodeId child = tree.member(obj, key);
 
     // 如果 child 是数组，则把剩余路径应用到数组上（数组元素上会继续递归）
-    if (child.isArray()) {
-        QJsonArray arr = child.toArray();
-        // apply to arr at nextIdx
-        applyPathToArray(arr, parts, nextIdx, value);
-        obj.insert(key, arr);
+    if (tree.isArray(child)) {
+        applyPathToArray(tree, child, parts, nextIdx, value);
         return;
     }
 
-  
-    if (child.isObject()) {
-        QJsonObject childObj = child.toObject();
-        applyPathToObject(childObj, parts, nextIdx, value);
-        obj.insert(key, childObj);
+    if (tree.isObject(child)) {
+        applyPathToObject(tree, child, parts, nextIdx, value);
         return;
     }
 
- 
     if (nextIdx == parts.size() - 1 && value.isArray()) {
         // 在 obj[key] 创建一个数组，每个 value 元素创建一个对象 { finalKey: elem }
-        QJsonArray newArr;
-        for (const QJsonValue& elem : value.toArray()) {
-            QJsonObject newObj;
-            newObj.insert(parts[nextIdx], elem);
-            newArr.append(newObj);
-        }
-        obj.insert(key, newArr);
+        const JsonTree::NodeId newArr = tree.arrayAt(obj, key);
+        for (const QJsonValue& elem : value.toArray())
+            tree.setValue(tree.appendObject(newArr), parts[nextIdx], elem);
         return;
     }
 
     // 否则创建一个中间对象并继续递归
-    QJsonObject newChildObj;
-    applyPathToObject(newChildObj, parts, nextIdx, value);
-    obj.insert(key, newChildObj);
+    applyPathToObject(tree, tree.objectAt(obj, key), parts, nextIdx, value);
 }
 
 // 主公开函数：path 可以是 "a.b.c" 这样的点分隔路径
@@ -504,8 +529,10 @@ void ParameterHelper::JsonUpdateRfidKey(QJsonObject& inputObj, const QString& pa
     QStringList parts = path.split('.', QString::SkipEmptyParts);
     if (parts.isEmpty()) return;
 
-    // 从根对象开始递归应用
-    applyPathToObject(inputObj, parts, 0, value);
+    // 从根对象开始在构建树上就地应用，最后一次性写回
+    JsonTree tree(inputObj);
+    applyPathToObject(tree, tree.root(), parts, 0, value);
+    inputObj = tree.toObject();
 }
 
 /**
@@ -4,8 +4,10 @@
 #include <QVariant>
 #include <QVariantMap>
 #include <QString>
-#include <QReadWriteLock>
+#include <QHash>
 #include <QJsonObject>
+#include <memory>
+#include "JsonTree.h"
 
 #include "eapcore_global.h"
 class EAPCORE_EXPORT ParameterHelper
@@ -22,6 +24,8 @@ public:
     // QJsonObject 版本的合并接口
     static void JsonmergeTo(QJsonObject& inputMap, const QString& interfaceName, const QString& keyName);
     static void JsonmergeAllTo(QJsonObject& inputMap, const QString& interfaceName);
+    // 构建树版本（buildPayload 在树上就地补齐默认参数）
+    static void JsonmergeAllTo(JsonTree& tree, JsonTree::NodeId obj, const QString& interfaceName);
 
     static void JsonmergeToFromJson(QJsonObject& inputMap, const QJsonObject& obj, const QString& keyName);
     static void JsonmergeAllToFromJson(QJsonObject& inputMap, const QJsonObject& obj);
@@ -39,10 +43,19 @@ public:
 private:
     ParameterHelper() = delete;
      
-    static QVariantMap s_params;
+    // 默认参数快照：loadDefaultParam 时一次性构建，之后只读，重新加载时整体原子替换
+    struct Snapshot {
+        QVariantMap params;                       // 原始配置（接口名 → 参数）
+        QHash<QString, QJsonObject> jsonDefaults; // 每个接口的默认参数，已转换为 JSON
+    };
 
-    // 不再声明拷贝不可用的静态成员，改为通过函数获取引用
-    static QReadWriteLock& lock();
+    // 取当前快照（读路径不加锁；未加载时为空指针）
+    static std::shared_ptr<const Snapshot> snapshot();
+
+    static std::shared_ptr<const Snapshot> s_snapshot;
+
+    // JSON 值是否“空”（与 isEmptyVariant(v.toVariant()) 等价，省去转换）
+    static bool isEmptyJson(const QJsonValue& v);
 
     // 判断 QVariant 是否“空”——用于判定已存在但“无值”的情况
     static bool isEmptyVariant(const QVariant& v);
@@ -128,6 +128,67 @@ bool VendorConfigLoader::loadFromFile(const QString& path,
             meta.retryStrategy.noRetryValue = rs.value("no_retry_value").toVariant();
         }
 
+        // === 解析自适应超时 ===  （adaptive_timeout：有效超时 = clamp(k × p99, min_ms, max_ms)）
+        if (obj.contains("adaptive_timeout") && obj.value("adaptive_timeout").isObject()) {
+            const QJsonObject at = obj.value("adaptive_timeout").toObject();
+            meta.adaptiveTimeout.enabled = at.value("enabled").toBool(true);
+            meta.adaptiveTimeout.k = at.value("k").toDouble(3.0);
+            meta.adaptiveTimeout.minMs = at.value("min_ms").toInt(200);
+            meta.adaptiveTimeout.maxMs = at.value("max_ms").toInt(qMax(meta.timeoutMs, 30000));
+            meta.adaptiveTimeout.minSamples = at.value("min_samples").toInt(20);
+            if (meta.adaptiveTimeout.maxMs < meta.adaptiveTimeout.minMs)
+                meta.adaptiveTimeout.maxMs = meta.adaptiveTimeout.minMs;
+        }
+
+        // === 解析对冲策略 ===  （hedge_after_ms 简写，或 hedge 段：after_ms / at_percentile / max_ratio / min_samples）
+        if (obj.contains("hedge_after_ms")) {
+            meta.hedgePolicy.afterMs = obj.value("hedge_after_ms").toInt(0);
+        }
+        if (obj.contains("hedge") && obj.value("hedge").isObject()) {
+            const QJsonObject hg = obj.value("hedge").toObject();
+            meta.hedgePolicy.afterMs = hg.value("after_ms").toInt(meta.hedgePolicy.afterMs);
+            meta.hedgePolicy.atPercentile = hg.value("at_percentile").toDouble(0.0);
+            meta.hedgePolicy.maxRatio = hg.value("max_ratio").toDouble(0.1);
+            meta.hedgePolicy.minSamples = hg.value("min_samples").toInt(20);
+        }
+
+        // === 解析响应缓存 ===  （cache_ttl_ms / cache_ignore_fields）
+        meta.cacheTtlMs = obj.value("cache_ttl_ms").toInt(0);
+        if (obj.contains("cache_ignore_fields") && obj.value("cache_ignore_fields").isArray()) {
+            for (const QJsonValue& f : obj.value("cache_ignore_fields").toArray())
+                meta.cacheIgnoreFields << f.toString();
+        }
+
+        // === 解析批量上传 ===  （batch 段：max_items / linger_ms / group_key / item_key / failed_items_key / max_attempts）
+        if (obj.contains("batch") && obj.value("batch").isObject()) {
+            const QJsonObject bt = obj.value("batch").toObject();
+            meta.batch.maxItems = bt.value("max_items").toInt(0);
+            meta.batch.lingerMs = bt.value("linger_ms").toInt(0);
+            meta.batch.groupKey = bt.value("group_key").toString();
+            meta.batch.itemKey = bt.value("item_key").toString();
+            meta.batch.failedItemsKey = bt.value("failed_items_key").toString();
+            meta.batch.maxAttempts = bt.value("max_attempts").toInt(meta.batch.maxAttempts);
+        }
+
+        // === 解析离线 / 半自动分发开关 ===  （offlineEnabled / offlineCache / semiAutoEnabled）
+        meta.dispatchFlagsConfigured = obj.contains("offlineEnabled") || obj.contains("offlineCache") || obj.contains("semiAutoEnabled");
+        meta.offlineEnabled = obj.value("offlineEnabled").toBool(false);
+        meta.offlineCache = obj.value("offlineCache").toBool(false);
+        meta.semiAutoEnabled = obj.value("semiAutoEnabled").toBool(true);
+
+        // === 解析队列保留策略 ===  （queue_policy："replay_all" / "latest_only_per_key" 简写，
+        //      或对象：mode / key_fields / drop_when_stale_after_ms）
+        {
+            const QJsonValue qp = obj.value("queue_policy");
+            const QJsonObject qpObj = qp.isObject() ? qp.toObject() : QJsonObject();
+            const QString mode = qp.isString() ? qp.toString() : qpObj.value("mode").toString();
+            if (mode.compare("latest_only_per_key", Qt::CaseInsensitive) == 0)
+                meta.queuePolicy.mode = QueuePolicy::Mode::LatestOnlyPerKey;
+            for (const QJsonValue& f : qpObj.value("key_fields").toArray())
+                meta.queuePolicy.keyFields << f.toString();
+            meta.queuePolicy.dropWhenStaleAfterMs = static_cast<qint64>(qpObj.value("drop_when_stale_after_ms").toDouble(0));
+        }
+
         outMap[key] = meta;
     }
 
@@ -20,6 +20,9 @@
 
 #include <QString>
 #include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QSharedPointer>
 #include <QJsonObject>
 #include <QJsonDocument>
 
@@ -30,6 +33,28 @@ EAPEnvelope 这套代码，就是帮你适配各种“包一层壳”的 JSON 
 */
 namespace EAPEnvelope 
 {
+    // 单个接口生效的外壳方案（由 Config 展平得到，加载后不可变）
+    struct Plan {
+        QString outHead;
+        QString outBody;
+        QString inHead;
+        QString inBody;
+        bool stripForcedHeader = true;
+        bool strictMatch = true;
+
+        // 预先判定的分支
+        bool outPassthrough = false; // outHead/outBody 均为空：发送原样透传
+        bool inPassthrough = false;  // inHead/inBody 均为空：接收原样透传
+        bool outLegacy = false;      // outHead="header" 且 outBody="body"：沿用旧键名
+        bool inNative = false;       // inHead="header" 且 inBody="body"：对端本就是内部格式
+    };
+
+    // 方案表：default + 每接口（按接口名哈希查找）
+    struct PlanTable {
+        Plan defaults;
+        QHash<QString, Plan> interfaces;
+    };
+
     // 外壳键名与行为配置（仅全局 default）
     struct Config {
         QString outHead = "head";    // 发送出去时，头部字段的 key
@@ -42,8 +67,51 @@ namespace EAPEnvelope
         bool strictMatch = true;       // 是否严格校验 URL 中 function_name 与 header.function_name 一致
 
         QMap<QString, Config> interfaces; // 每个接口单独的配置（覆盖 default）
+
+        // 展平后的方案表（loadConfigFromFile / buildPlans 生成，拷贝 Config 时共享）
+        QSharedPointer<const PlanTable> plans;
     };
 
+    inline Plan makePlan(const Config& c) {
+        Plan p;
+        p.outHead = c.outHead;
+        p.outBody = c.outBody;
+        p.inHead = c.inHead;
+        p.inBody = c.inBody;
+        p.stripForcedHeader = c.stripForcedHeader;
+        p.strictMatch = c.strictMatch;
+        p.outPassthrough = c.outHead.isEmpty() && c.outBody.isEmpty();
+        p.inPassthrough = c.inHead.isEmpty() && c.inBody.isEmpty();
+        p.outLegacy = c.outHead == QStringLiteral("header") && c.outBody == QStringLiteral("body");
+        p.inNative = c.inHead == QStringLiteral("header") && c.inBody == QStringLiteral("body");
+        return p;
+    }
+
+    // 由 Config 的 default 段与 interfaces 生成方案表；手工修改 Config 字段后需重新调用
+    inline void buildPlans(Config& cfg) {
+        QSharedPointer<PlanTable> table(new PlanTable);
+        table->defaults = makePlan(cfg);
+        table->interfaces.reserve(cfg.interfaces.size());
+        for (auto it = cfg.interfaces.constBegin(); it != cfg.interfaces.constEnd(); ++it)
+            table->interfaces.insert(it.key(), makePlan(it.value()));
+        cfg.plans = table;
+    }
+
+    // 给定一个接口名，返回该接口生效的方案（常量引用，不拷贝配置）；未单独配置则为 default
+    inline const Plan& planFor(const QString& interfaceKey, const Config& cfg) {
+        if (!cfg.plans) {
+            // 未经 loadConfigFromFile/buildPlans 的 Config 视为内置默认值
+            static const Plan s_builtin = makePlan(Config());
+            return s_builtin;
+        }
+        if (!interfaceKey.isEmpty()) {
+            const auto it = cfg.plans->interfaces.constFind(interfaceKey);
+            if (it != cfg.plans->interfaces.constEnd())
+                return it.value();
+        }
+        return cfg.plans->defaults;
+    }
+
     // 将接口中的含有 Config 的参数配置改为 Config 的参数配置形式
     /*无引用--R*/
     inline bool loadConfigFromFile(const QString& path, Config& cfg, QString* errorOut = nullptr) {
@@ -61,8 +129,10 @@ namespace EAPEnvelope
         }
 
         const QJsonObject root = doc.object();
-        if (!root.contains("default") || !root.value("default").isObject())
+        if (!root.contains("default") || !root.value("default").isObject()) {
+            buildPlans(cfg);
             return true; //无 default 段则使用内置默认
+        }
 
         // 含有 default 的根配置
         const QJsonObject def = root.value("default").toObject();
@@ -81,6 +151,7 @@ namespace EAPEnvelope
                 if (!it.value().isObject()) continue;
                 const QJsonObject ifaceObj = it.value().toObject();
                 Config ifaceCfg = cfg; // 使用 default
+                ifaceCfg.interfaces.clear(); // 接口配置不再嵌套携带其它接口
                 if (ifaceObj.contains("out_head")) ifaceCfg.outHead = ifaceObj.value("out_head").toString(ifaceCfg.outHead);
                 if (ifaceObj.contains("out_body")) ifaceCfg.outBody = ifaceObj.value("out_body").toString(ifaceCfg.outBody);
                 if (ifaceObj.contains("in_head"))  ifaceCfg.inHead = ifaceObj.value("in_head").toString(ifaceCfg.inHead);
@@ -91,6 +162,7 @@ namespace EAPEnvelope
             }
         }
 
+        buildPlans(cfg);
         return true;
     }
 
@@ -119,10 +191,10 @@ namespace EAPEnvelope
     // - 若 outHead="header" 且 outBody="body"，则保持旧协议键名不变
     // - 当 stripForcedHeader=true 时，移除强制头字段
     inline QJsonObject wrapOutgoing(const QJsonObject& hbOrBody, const Config& baseCfg, const QString& interfaceKey = QString()) {
-        // 按接口解析出生效配置
-        const Config cfg = resolveConfig(interfaceKey, baseCfg);
+        // 按接口取预先展平的方案（不拷贝配置）
+        const Plan& cfg = planFor(interfaceKey, baseCfg);
         // 直通模式（passthrough）直接返回
-        if (isPassthrough(cfg.outHead) && isPassthrough(cfg.outBody)) {
+        if (cfg.outPassthrough) {
             return hbOrBody;
         }
 
@@ -145,7 +217,7 @@ namespace EAPEnvelope
         }
 
         // 旧协议：直接用 header/body 作为键名
-        if (cfg.outHead == QStringLiteral("header") && cfg.outBody == QStringLiteral("body")) {
+        if (cfg.outLegacy) {
             QJsonObject out;
             if (!h.isEmpty()) out.insert(QStringLiteral("header"), h);
             if (!b.isEmpty()) out.insert(QStringLiteral("body"), b);
@@ -164,6 +236,16 @@ namespace EAPEnvelope
         return out;
     }
 
+    // 报文是否已是归一化后的形状：只含 header / body 两个键且均为对象
+    inline bool isNormalizedShape(const QJsonObject& in) {
+        if (in.size() > 2) return false;
+        for (auto it = in.constBegin(); it != in.constEnd(); ++it) {
+            if (it.key() != QStringLiteral("header") && it.key() != QStringLiteral("body")) return false;
+            if (!it.value().isObject()) return false;
+        }
+        return true;
+    }
+
     // 目的：
     // 接收后，把各种：
     // { response_head,response_body }
@@ -173,18 +255,24 @@ namespace EAPEnvelope
     // 统一整理成内部格式：{ "header": ..., "body" : ... }
     inline QJsonObject normalizeIncoming(const QJsonObject& in, const Config& baseCfg,
         bool* hadEnvelope = nullptr, QString* envelopeType = nullptr, const QString& interfaceKey = QString()) {
-        // 先解析当前接口的配置，并初始化标记
-        const Config cfg = resolveConfig(interfaceKey, baseCfg);
+        // 先取当前接口的方案，并初始化标记
+        const Plan& cfg = planFor(interfaceKey, baseCfg);
         if (hadEnvelope) *hadEnvelope = false;
         if (envelopeType) envelopeType->clear();
 
         // passthrough 模式：原样返回
-        if (isPassthrough(cfg.inHead) && isPassthrough(cfg.inBody)) {
+        if (cfg.inPassthrough) {
             return in;
         }
 
         // 1) 优先按配置的 inHead/inBody 拆壳（通常是 response_head/response_body）
         if (in.contains(cfg.inHead) || in.contains(cfg.inBody)) {
+            if (cfg.inNative && isNormalizedShape(in)) {
+                // 快速路径：已是 {header, body}，无需重建
+                if (hadEnvelope) *hadEnvelope = true;
+                if (envelopeType) *envelopeType = QStringLiteral("response");
+                return in;
+            }
             QJsonObject out;
             if (in.value(cfg.inHead).isObject())
                 out.insert(QStringLiteral("header"), in.value(cfg.inHead).toObject());
@@ -209,6 +297,9 @@ namespace EAPEnvelope
 
         // 3) 再次兼容原生 header/body 格式
         if (in.contains(QStringLiteral("header")) || in.contains(QStringLiteral("body"))) {
+            if (isNormalizedShape(in)) {
+                return in; // 快速路径：已是 {header, body}，无需重建
+            }
             QJsonObject out;
             if (in.value(QStringLiteral("header")).isObject())
                 out.insert(QStringLiteral("header"), in.value(QStringLiteral("header")).toObject());
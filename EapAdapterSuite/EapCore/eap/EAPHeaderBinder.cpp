@@ -6,26 +6,20 @@
 #include <QUuid>
 #include <QProcessEnvironment>
 
-/**
- * @brief 按指定格式返回当前时间字符串
- * @param fmt 时间格式字符串（如 "yyyyMMddHHmmss"），为空则使用默认格式
- * @return 格式化后的当前时间字符串
- */
-static QString expandNow(const QString& fmt) {
-    return QDateTime::currentDateTime().toString(fmt.isEmpty() ? "yyyy-MM-dd HH:mm:ss" : fmt);
-}
+static const QString kDefaultNowFormat = QStringLiteral("yyyy-MM-dd HH:mm:ss");
 
 /**
  * @brief 从 JSON 配置文件加载 EAP 请求 header 参数模板
  *
  * 从指定路径的 JSON 文件中读取 header 参数配置：
- * - "default" 段会被保存到成员 defaultHeader_，作为全局默认 header 字段集合；
- * - "interfaces" 段中每个接口对应的对象会被保存到 perInterfaceHeader_，用于覆盖或扩展默认 header。
+ * - "default" 段作为全局默认 header 字段集合，编译后保存到 mergedDefault_；
+ * - "interfaces" 段中每个接口对应的对象覆盖或扩展默认 header，与 default 合并后编译保存到 mergedPerInterface_。
+ * 字符串值中的占位符在此解析为片段列表，${env:XXX} 在此读取环境变量并缓存。
  * 若文件无法打开或 JSON 解析失败，则返回 false，并在 errorOut 中给出错误信息。
  *
  * @param path     header 参数配置文件路径（JSON 格式）
  * @param errorOut 若非空，在加载失败时写入错误描述字符串
- * @return true  加载成功，defaultHeader_ / perInterfaceHeader_ 已更新
+ * @return true  加载成功，mergedDefault_ / mergedPerInterface_ 已更新
  * 
  * 无引用--R
  */
@@ -45,111 +39,211 @@ bool EAPHeaderBinder::loadFromFile(const QString& path, QString* errorOut) {
         return false;
     }
 
-    defaultHeader_.clear();
-    perInterfaceHeader_.clear();
+    mergedDefault_.clear();
+    mergedPerInterface_.clear();
+
+    // 环境变量整体只取一次
+    const QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
 
     // 读取 default 段（全局 header 模板）
     const QJsonObject root = doc.object();
     if (root.contains("default") && root.value("default").isObject()) {
-        defaultHeader_ = root.value("default").toObject().toVariantMap();
+        const QVariantMap defaults = root.value("default").toObject().toVariantMap();
+        for (auto it = defaults.constBegin(); it != defaults.constEnd(); ++it)
+            mergedDefault_.insert(it.key(), compileField(it.value(), env));
     }
 
-    // 读取 interfaces 段（各接口单独 header 模板）
+    // 读取 interfaces 段（各接口单独 header 模板），与 default 合并
     if (root.contains("interfaces") && root.value("interfaces").isObject()) {
         const auto m = root.value("interfaces").toObject();
         for (auto it = m.begin(); it != m.end(); ++it) {
             if (!it.value().isObject()) continue;
-            perInterfaceHeader_.insert(it.key(), it.value().toObject().toVariantMap());
+            FieldMap merged = mergedDefault_;
+            const QVariantMap overrides = it.value().toObject().toVariantMap();
+            for (auto o = overrides.constBegin(); o != overrides.constEnd(); ++o)
+                merged.insert(o.key(), compileField(o.value(), env));
+            mergedPerInterface_.insert(it.key(), merged);
         }
     }
     return true;
 }
 
 /**
- * @brief 展开 header 模板字符串中的占位符，生成最终可发送的字符串值
+ * @brief 把一个 header 模板值解析为片段列表
  *
  * 支持在配置文件中通过特殊占位符动态生成字段内容，例如：
  * - ${uuid}              ：替换为随机 UUID（无花括号）
  * - ${name}              ：替换为接口配置中的 meta.name
  * - ${nameNoSlash}       ：替换为去掉前导 '/' 的接口名（若有）
  * - ${now:fmt}           ：按给定时间格式 fmt 展开当前时间，如 ${now:yyyyMMddHHmmss}
- * - ${env:VAR}           ：从系统环境变量 VAR 中读取值
+ * - ${env:VAR}           ：系统环境变量 VAR 的值（此处读取并缓存）
  * - ${ts:epoch_ms}       ：当前时间戳（毫秒，自 1970 起）
  * - ${ts:epoch_s}        ：当前时间戳（秒，自 1970 起）
  * - ${custom:Provider}   ：调用自定义 provider（customProviders_ 中注册）生成值
  *
- * 函数会在传入的字符串 s 上依次执行以上占位符替换，并返回替换后的结果字符串（封装在 QVariant 中）。
- * 若字符串不包含任何占位符，则原样返回。
+ * 无法识别的 ${...} 与未闭合的 "${" 按普通文本保留。
+ * 非字符串值、不含占位符的字符串不生成片段，展开时直接使用原值。
  *
- * @param s            原始模板字符串（可能包含 ${...} 占位符）
- * @param interfaceKey 当前接口 key，用于传入自定义 provider（如 "CheckUser"）
- * @param meta         当前接口的元数据（EapInterfaceMeta，用于 ${name}/${nameNoSlash} 等）
- * @return QVariant    展开占位符后的最终字符串值
+ * @param v   配置中的原始值
+ * @param env 加载时的系统环境变量快照
+ * @return Field 编译结果
  */
-QVariant EAPHeaderBinder::expandValue(const QString& s,
-    const QString& interfaceKey,
-    const EapInterfaceMeta& meta) const {
-    // 仅处理简单字符串占位符，其他类型原样返回
-    QString out = s;
-
-    // ${uuid}--新生成的 UUID
-    out.replace("${uuid}", QUuid::createUuid().toString(QUuid::WithoutBraces));
-
-    // ${name} / ${nameNoSlash}--使用接口名
-    out.replace("${name}", meta.name);
-    {
-        QString ns = meta.name;
-        if (ns.startsWith('/')) ns.remove(0, 1);
-        out.replace("${nameNoSlash}", ns);
-    }
+EAPHeaderBinder::Field EAPHeaderBinder::compileField(const QVariant& v, const QProcessEnvironment& env) {
+    Field f;
+    f.value = v;
+    if (v.userType() != QMetaType::QString)
+        return f;
+
+    const QString s = v.toString();
+    if (!s.contains(QLatin1String("${")))
+        return f;
+
+    QString literal;
+    bool hasPlaceholder = false;
+    auto addToken = [&f](const Token& t) {
+        f.tokens.append(t);
+        f.reserve += t.text.size();
+    };
+    auto flushLiteral = [&]() {
+        if (literal.isEmpty()) return;
+        Token t;
+        t.text = literal;
+        addToken(t);
+        literal.clear();
+    };
+
+    int pos = 0;
+    while (pos < s.size()) {
+        int start = s.indexOf(QLatin1String("${"), pos);
+        const int end = start < 0 ? -1 : s.indexOf(QLatin1Char('}'), start + 2);
+        if (end < 0) {
+            literal += s.midRef(pos);
+            break;
+        }
+        // "${a${uuid}" 这类情况以最靠近 '}' 的 "${" 为准
+        start = s.lastIndexOf(QLatin1String("${"), end);
+        literal += s.midRef(pos, start - pos);
+
+        const QString inner = s.mid(start + 2, end - start - 2);
+        Token t;
+        if (inner == QLatin1String("uuid")) {
+            t.kind = Token::Uuid;
+            f.reserve += 36;
+        }
+        else if (inner == QLatin1String("name")) {
+            t.kind = Token::Name;
+            f.reserve += 32;
+        }
+        else if (inner == QLatin1String("nameNoSlash")) {
+            t.kind = Token::NameNoSlash;
+            f.reserve += 32;
+        }
+        else if (inner.startsWith(QLatin1String("now:"))) {
+            t.kind = Token::Now;
+            const QString fmt = inner.mid(4);
+            t.text = fmt.isEmpty() ? kDefaultNowFormat : fmt;
+        }
+        else if (inner.startsWith(QLatin1String("env:"))) {
+            // 环境变量在加载时即为定值，直接并入文本
+            literal += env.value(inner.mid(4), QString());
+            pos = end + 1;
+            continue;
+        }
+        else if (inner == QLatin1String("ts:epoch_ms")) {
+            t.kind = Token::TsMs;
+            f.reserve += 13;
+        }
+        else if (inner == QLatin1String("ts:epoch_s")) {
+            t.kind = Token::TsS;
+            f.reserve += 10;
+        }
+        else if (inner.startsWith(QLatin1String("custom:"))) {
+            t.kind = Token::Custom;
+            t.text = inner.mid(7);
+            t.raw = s.mid(start, end - start + 1);
+            f.reserve += 32;
+        }
+        else {
+            literal += s.midRef(start, end - start + 1); // 未知占位符原样保留
+            pos = end + 1;
+            continue;
+        }
 
-    // ${now:...}--当前时间按指定格式
-    // 形如 ${now:yyyy-MM-dd HH:mm:ss}
-    int idx = 0;
-    while ((idx = out.indexOf("${now:", idx)) >= 0) {
-        int end = out.indexOf('}', idx);
-        if (end < 0) break;
-        const QString token = out.mid(idx, end - idx + 1);
-        const QString fmt = token.mid(QString("${now:").size(),
-            token.size() - QString("${now:").size() - 1);
-        out.replace(token, expandNow(fmt));
-        idx = idx + 1;
+        flushLiteral();
+        addToken(t);
+        hasPlaceholder = true;
+        pos = end + 1;
     }
+    flushLiteral();
 
-    // ${env:XXX} -- 读取系统环境变量
-    idx = 0;
-    while ((idx = out.indexOf("${env:", idx)) >= 0) {
-        int end = out.indexOf('}', idx);
-        if (end < 0) break;
-        const QString token = out.mid(idx, end - idx + 1);
-        const QString envName = token.mid(QString("${env:").size(),
-            token.size() - QString("${env:").size() - 1);
-        const QString envValue = QProcessEnvironment::systemEnvironment().value(envName, "");
-        out.replace(token, envValue);
-        idx = idx + 1;
+    if (!hasPlaceholder) {
+        // 只有文本（含 ${env:...}）：直接保存展开结果
+        QString text;
+        text.reserve(f.reserve);
+        for (const Token& t : f.tokens) text += t.text;
+        f.value = text;
+        f.tokens.clear();
+        return f;
     }
+    f.isTemplate = true;
+    return f;
+}
 
-    // ${ts:epoch_ms} -- 当前时间戳（毫秒）
-    out.replace("${ts:epoch_ms}", QString::number(QDateTime::currentMSecsSinceEpoch()));
-    
-    // ${ts:epoch_s} -- 当前时间戳（秒）
-    out.replace("${ts:epoch_s}", QString::number(QDateTime::currentSecsSinceEpoch()));
-
-    // ${custom:XXX} -- 自定义占位符
-    idx = 0;
-    while ((idx = out.indexOf("${custom:", idx)) >= 0) {
-        int end = out.indexOf('}', idx);
-        if (end < 0) break;
-        const QString token = out.mid(idx, end - idx + 1);
-        const QString providerName = token.mid(QString("${custom:").size(),
-            token.size() - QString("${custom:").size() - 1);
-        if (customProviders_.contains(providerName)) {
-            const QString customValue = customProviders_.value(providerName)(interfaceKey, meta);
-            out.replace(token, customValue);
+/**
+ * @brief 按编译好的片段列表展开 header 模板，生成最终可发送的字符串值
+ *
+ * 片段顺序拼接到预留好容量的字符串中；同一个值里的 ${uuid} 共用一个 UUID，
+ * ${now:...} / ${ts:...} 共用同一时刻。
+ *
+ * @param f            compileField 的结果（isTemplate 为 true）
+ * @param interfaceKey 当前接口 key，用于传入自定义 provider（如 "CheckUser"）
+ * @param meta         当前接口的元数据（EapInterfaceMeta，用于 ${name}/${nameNoSlash} 等）
+ * @return QString     展开占位符后的最终字符串值
+ */
+QString EAPHeaderBinder::expandValue(const Field& f,
+    const QString& interfaceKey,
+    const EapInterfaceMeta& meta) const {
+    QString out;
+    out.reserve(f.reserve);
+
+    QString uuid;
+    QDateTime now;
+    for (const Token& t : f.tokens) {
+        switch (t.kind) {
+        case Token::Literal:
+            out += t.text;
+            break;
+        case Token::Uuid:
+            if (uuid.isEmpty()) uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+            out += uuid;
+            break;
+        case Token::Name:
+            out += meta.name;
+            break;
+        case Token::NameNoSlash:
+            if (meta.name.startsWith(QLatin1Char('/'))) out += meta.name.midRef(1);
+            else out += meta.name;
+            break;
+        case Token::Now:
+            if (!now.isValid()) now = QDateTime::currentDateTime();
+            out += now.toString(t.text);
+            break;
+        case Token::TsMs:
+            if (!now.isValid()) now = QDateTime::currentDateTime();
+            out += QString::number(now.toMSecsSinceEpoch());
+            break;
+        case Token::TsS:
+            if (!now.isValid()) now = QDateTime::currentDateTime();
+            out += QString::number(now.toSecsSinceEpoch());
+            break;
+        case Token::Custom: {
+            // provider 可能在加载之后才注册，展开时按名称查找；未注册则保留占位符
+            const auto it = customProviders_.constFind(t.text);
+            out += (it != customProviders_.constEnd()) ? it.value()(interfaceKey, meta) : t.raw;
+            break;
+        }
         }
-        idx = idx + 1;
     }
-
     return out;
 }
 
@@ -179,30 +273,20 @@ QVariantMap EAPHeaderBinder::mergedParamsFor(const QString& interfaceKey,
     // 仅针对 meta.headerMap 中的本地字段进行合并
     QVariantMap out = inputParams;
 
-    // 先拿 default
-    QVariantMap merged = defaultHeader_;
-    // 覆盖接口定制
-    if (perInterfaceHeader_.contains(interfaceKey)) {
-        for (auto it = perInterfaceHeader_[interfaceKey].begin();
-            it != perInterfaceHeader_[interfaceKey].end(); ++it) {
-            merged.insert(it.key(), it.value());
-        }
-    }
+    // 接口定制已在加载时与 default 合并；没有定制的接口直接使用 default
+    const auto pit = mergedPerInterface_.constFind(interfaceKey);
+    const FieldMap& merged = (pit != mergedPerInterface_.constEnd()) ? pit.value() : mergedDefault_;
 
     // 展开占位符，并仅在 headerMapping 中存在时写入
-    for (auto it = meta.headerMap.begin(); it != meta.headerMap.end(); ++it) {
-        const QString localKey = it.key(); // 本地 header 字段
+    for (auto it = meta.headerMap.constBegin(); it != meta.headerMap.constEnd(); ++it) {
+        const QString& localKey = it.key(); // 本地 header 字段
         if (out.contains(localKey)) continue; // 已传入则不覆盖
-        if (!merged.contains(localKey)) continue;
+        const auto fit = merged.constFind(localKey);
+        if (fit == merged.constEnd()) continue;
 
-        const QVariant v = merged.value(localKey);
-        if (v.userType() == QMetaType::QString) {
-            out.insert(localKey, expandValue(v.toString(), interfaceKey, meta));
-        }
-        else {
-            out.insert(localKey, v);
-        }
+        const Field& f = fit.value();
+        out.insert(localKey, f.isTemplate ? QVariant(expandValue(f, interfaceKey, meta)) : f.value);
     }
 
     return out;
-}
\ No newline at end of file
+}
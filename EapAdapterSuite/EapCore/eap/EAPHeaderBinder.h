@@ -1,10 +1,14 @@
 #pragma once
 #include <QVariantMap>
 #include <QMap>
+#include <QHash>
+#include <QVector>
 #include <QString>
 #include <functional>
 #include "EapInterfaceMeta.h"
 
+class QProcessEnvironment;
+
 class EAPHeaderBinder {
 public:
     // 自定义占位符 provider 回调类型
@@ -23,6 +27,7 @@ public:
     // 基于接口与 meta 的 headerMapping，将"可用的 header 本地字段"从配置合并进输入 params
     // - 仅合并 meta.headerMap 里存在的本地字段键
     // - 支持占位符展开：${now:...}, ${uuid}, ${name}, ${nameNoSlash}, ${env:XXX}, ${ts:epoch_ms}, ${ts:epoch_s}, ${custom:XXX}
+    // - 模板在 loadFromFile 时已解析，这里只做一次顺序拼接；${env:XXX} 取加载时的环境变量值
     QVariantMap mergedParamsFor(const QString& interfaceKey,
         const EapInterfaceMeta& meta,
         const QVariantMap& inputParams) const;
@@ -33,12 +38,33 @@ public:
     void registerPlaceholderProvider(const QString& name, PlaceholderProvider callback);
 
 private:
-    QVariant expandValue(const QString& s,
+    // 模板中的一个片段
+    struct Token {
+        enum Kind { Literal, Uuid, Name, NameNoSlash, Now, TsMs, TsS, Custom };
+        Kind kind = Literal;
+        QString text; // Literal：文本（${env:XXX} 加载时已并入）；Now：时间格式；Custom：provider 名称
+        QString raw;  // Custom：原始占位符（provider 未注册时原样输出）
+    };
+
+    // 加载时解析好的 header 模板：不含占位符的字符串与非字符串值直接保存在 value 中
+    struct Field {
+        QVariant value;
+        QVector<Token> tokens;
+        int reserve = 0;      // 展开结果的预估长度
+        bool isTemplate = false;
+    };
+    using FieldMap = QMap<QString, Field>;
+
+    static Field compileField(const QVariant& v, const QProcessEnvironment& env);
+
+    QString expandValue(const Field& f,
         const QString& interfaceKey,
         const EapInterfaceMeta& meta) const;
 
 private:
-    QVariantMap defaultHeader_;
-    QMap<QString, QVariantMap> perInterfaceHeader_;
     QMap<QString, PlaceholderProvider> customProviders_;
+
+    // default 与各接口覆盖合并后的编译结果（loadFromFile 时生成）
+    FieldMap mergedDefault_;
+    QHash<QString, FieldMap> mergedPerInterface_;
 };
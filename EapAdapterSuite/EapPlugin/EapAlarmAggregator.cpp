@@ -0,0 +1,162 @@
+﻿#include "EapAlarmAggregator.h"
+
+#include <QTimer>
+#include <QPair>
+#include <algorithm>
+#include <limits>
+
+EapAlarmAggregator::EapAlarmAggregator(QObject* parent)
+    : QObject(parent)
+{
+    clock_.start();
+    flushTimer_ = new QTimer(this);
+    flushTimer_->setSingleShot(true);
+    connect(flushTimer_, &QTimer::timeout, this, &EapAlarmAggregator::flush);
+}
+
+EapAlarmAggregator::~EapAlarmAggregator()
+{
+}
+
+void EapAlarmAggregator::setDebounceMs(int ms)
+{
+    debounceMs_ = qMax(0, ms);
+}
+
+void EapAlarmAggregator::setMaxBatch(int count)
+{
+    maxBatch_ = qMax(1, count);
+}
+
+void EapAlarmAggregator::submit(const QString& code, const QString& status)
+{
+    Entry& e = entries_[code];
+
+    if (!e.pending.isEmpty()) {
+        if (status == e.pending) {
+            // 待定期间重复的相同状态
+            ++e.suppressed;
+            ++suppressedTotal_;
+            return;
+        }
+        if (status == e.reported) {
+            // 待定期间又恢复原状态：闪断，两条都不上报
+            e.pending.clear();
+            --pendingCount_;
+            e.suppressed += 2;
+            suppressedTotal_ += 2;
+            return;
+        }
+        // 待定期间变为第三种状态：以新状态重新计时
+        ++e.suppressed;
+        ++suppressedTotal_;
+        e.pending = status;
+        e.pendingSince = QDateTime::currentDateTime();
+        e.sinceMs = clock_.elapsed();
+        e.dueMs = e.sinceMs + debounceMs_;
+        scheduleFlush();
+        return;
+    }
+
+    if (status == e.reported) {
+        // 状态未变化
+        ++e.suppressed;
+        ++suppressedTotal_;
+        return;
+    }
+
+    e.pending = status;
+    e.pendingSince = QDateTime::currentDateTime();
+    e.sinceMs = clock_.elapsed();
+    e.dueMs = e.sinceMs + debounceMs_;
+    ++pendingCount_;
+    scheduleFlush();
+}
+
+void EapAlarmAggregator::setReportedState(const QString& code, const QString& status)
+{
+    Entry& e = entries_[code];
+    if (!e.pending.isEmpty()) {
+        e.pending.clear();
+        --pendingCount_;
+    }
+    e.reported = status;
+    e.suppressed = 0;
+}
+
+void EapAlarmAggregator::clear()
+{
+    entries_.clear();
+    pendingCount_ = 0;
+    flushTimer_->stop();
+}
+
+QStringList EapAlarmAggregator::codesInState(const QString& status) const
+{
+    QStringList codes;
+    for (auto it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+        if (it->reported == status)
+            codes.append(it.key());
+    }
+    return codes;
+}
+
+void EapAlarmAggregator::scheduleFlush()
+{
+    if (pendingCount_ <= 0) {
+        flushTimer_->stop();
+        return;
+    }
+
+    qint64 earliest = std::numeric_limits<qint64>::max();
+    for (const Entry& e : entries_) {
+        if (!e.pending.isEmpty())
+            earliest = qMin(earliest, e.dueMs);
+    }
+    const qint64 delay = qMax<qint64>(0, earliest - clock_.elapsed());
+    // 已有更早的排期时保持不变
+    if (flushTimer_->isActive() && flushTimer_->remainingTime() <= delay)
+        return;
+    flushTimer_->start(static_cast<int>(delay));
+}
+
+void EapAlarmAggregator::flush()
+{
+    const qint64 now = clock_.elapsed();
+
+    QList<QPair<qint64, Transition>> due; // (出现时的单调时钟读数, 变化)
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        Entry& e = it.value();
+        if (e.pending.isEmpty() || e.dueMs > now)
+            continue;
+        Transition t;
+        t.code = it.key();
+        t.status = e.pending;
+        t.time = e.pendingSince;
+        t.suppressed = e.suppressed;
+        due.append(qMakePair(e.sinceMs, t));
+
+        e.reported = e.pending;
+        e.pending.clear();
+        e.suppressed = 0;
+        --pendingCount_;
+    }
+
+    // 按单调时钟排序，系统校时不会打乱先后
+    std::stable_sort(due.begin(), due.end(),
+        [](const QPair<qint64, Transition>& a, const QPair<qint64, Transition>& b) { return a.first < b.first; });
+    reportedTotal_ += due.size();
+
+    QList<Transition> batch;
+    for (const auto& d : due) {
+        batch.append(d.second);
+        if (batch.size() >= maxBatch_) {
+            emit transitionsReady(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.isEmpty())
+        emit transitionsReady(batch);
+
+    scheduleFlush();
+}
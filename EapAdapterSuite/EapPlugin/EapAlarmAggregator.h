@@ -0,0 +1,99 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QStringList>
+#include <QList>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+class QTimer;
+
+/**
+ * @brief 告警聚合器
+ *
+ * 位于告警主题（TOPIC_ALARM_WARNING）与上报之间，告警风暴时削减上报次数：
+ * - 维护每个告警代码的状态表，只有状态真正变化才上报，重复的相同状态计入抑制次数；
+ * - 状态变化需保持 debounce 时间才生效，期间发生又恢复（闪断）的变化直接抵消并计入抑制次数；
+ * - 同一轮到期的变化一次性交给 transitionsReady()，由调用方决定合并为一条还是逐条上报。
+ *
+ * 所有接口需在聚合器所属线程（通常为 GUI 线程）调用。
+ */
+class EapAlarmAggregator : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 一次待上报的状态变化
+     */
+    struct Transition {
+        QString code;            ///< 告警代码
+        QString status;          ///< 新状态（occurrence / clear）
+        QDateTime time;          ///< 变化首次出现的时间
+        int suppressed = 0;      ///< 自上次上报以来该代码被抑制的消息条数
+    };
+
+    explicit EapAlarmAggregator(QObject* parent = nullptr);
+    ~EapAlarmAggregator() override;
+
+    /** @brief 状态变化的保持时间（毫秒），0 表示只合并同一轮事件循环内的变化 */
+    void setDebounceMs(int ms);
+    int debounceMs() const { return debounceMs_; }
+
+    /** @brief 单次 transitionsReady() 携带的变化上限（>= 1） */
+    void setMaxBatch(int count);
+
+    /**
+     * @brief 提交一条告警消息
+     * @param code   告警代码
+     * @param status 告警状态
+     */
+    void submit(const QString& code, const QString& status);
+
+    /**
+     * @brief 记录已在聚合器之外上报的状态（不触发上报，并撤销该代码待定的变化）
+     */
+    void setReportedState(const QString& code, const QString& status);
+
+    /** @brief 清空状态表与待定变化（例如切换离线时） */
+    void clear();
+
+    /** @brief 当前处于某状态的已上报告警代码 */
+    QStringList codesInState(const QString& status) const;
+
+    int pendingCount() const { return pendingCount_; }
+    /** @brief 累计被抑制（未单独上报）的消息条数 */
+    qint64 suppressedTotal() const { return suppressedTotal_; }
+    /** @brief 累计上报的状态变化条数 */
+    qint64 reportedTotal() const { return reportedTotal_; }
+
+signals:
+    /**
+     * @brief 一批状态变化已到期，需要上报
+     * @param transitions 按变化出现的先后排序
+     */
+    void transitionsReady(const QList<EapAlarmAggregator::Transition>& transitions);
+
+private:
+    struct Entry {
+        QString reported;        ///< 最近一次已上报的状态（空表示从未上报）
+        QString pending;         ///< 待定的新状态（空表示无待定变化）
+        QDateTime pendingSince;  ///< 待定变化首次出现的时间（仅用于上报）
+        qint64 sinceMs = 0;      ///< 待定变化出现时的单调时钟读数（毫秒，用于排序）
+        qint64 dueMs = 0;        ///< 待定变化到期时间（单调时钟读数，毫秒）
+        int suppressed = 0;      ///< 自上次上报以来被抑制的条数
+    };
+
+    void flush();
+    void scheduleFlush();
+
+    QHash<QString, Entry> entries_;
+    QTimer* flushTimer_ = nullptr;
+    QElapsedTimer clock_;        ///< 单调时钟：到期与排期不受系统校时影响
+    int debounceMs_ = 200;
+    int maxBatch_ = 50;
+    int pendingCount_ = 0;
+    qint64 suppressedTotal_ = 0;
+    qint64 reportedTotal_ = 0;
+};
@@ -5,6 +5,7 @@
 
 EapAlarmDialog::EapAlarmDialog(const QString& message, int autoCloseSeconds, QWidget* parent)
     : QDialog(parent)
+    , message_(message)
     , autoCloseSeconds_(autoCloseSeconds)
     , remainingSeconds_(autoCloseSeconds)
 {
@@ -143,6 +144,16 @@ int EapAlarmDialog::getRemainingTime() const
     return remainingSeconds_;
 }
 
+/**
+ * @brief 设置重复次数并刷新消息文本
+ * @param count 累计收到的次数；>1 时在消息后追加“（共收到 N 次）”
+ */
+void EapAlarmDialog::setRepeatCount(int count)
+{
+    repeatCount_ = count;
+    updateMessageLabel();
+}
+
 /**
  * @brief 自动关闭定时器的超时槽函数（每秒触发一次）
  */
@@ -190,3 +201,15 @@ void EapAlarmDialog::updateTimerLabel()
         timerLabel_->clear();
     }
 }
+
+/**
+ * @brief 根据消息内容与重复次数刷新消息标签
+ */
+void EapAlarmDialog::updateMessageLabel()
+{
+    if (repeatCount_ > 1) {
+        messageLabel_->setText(QString(QStringLiteral("%1\n（共收到 %2 次）")).arg(message_).arg(repeatCount_));
+    } else {
+        messageLabel_->setText(message_);
+    }
+}
@@ -38,6 +38,12 @@ public:
      */
     int getRemainingTime() const;
 
+    /**
+     * @brief 设置重复次数（相同消息合并到本对话框时调用）
+     * @param count 累计收到的次数（<= 1 时不显示次数）
+     */
+    void setRepeatCount(int count);
+
 signals:
     /**
      * @brief 对话框已确认（手动或自动）
@@ -57,12 +63,16 @@ private slots:
 private:
     void setupUI(const QString& message);
     void updateTimerLabel();
+    void updateMessageLabel();
 
 private:
     QLabel* messageLabel_;           ///< 消息显示标签 
     QLabel* timerLabel_;             ///< 倒计时显示标签
     QPushButton* confirmButton_;     ///< 确认按钮
-    QTimer* autoCloseTimer_;         ///< 自动关闭定时器
+    QTimer* autoCloseTimer_ = nullptr; ///< 自动关闭定时器
+
+    QString message_;                ///< 消息内容
+    int repeatCount_ = 1;            ///< 重复次数
 
     int autoCloseSeconds_;           ///< 自动关闭总秒数（0 表示不自动关闭）
     int remainingSeconds_;           ///< 剩余秒数
@@ -1,13 +1,14 @@
 ﻿#pragma execution_character_set("utf-8")
 #include "EapManager.h"
 #include "EapManagerConstants.h"
-#include "EapAlarmDialog.h"
+#include "EapNotificationCenter.h"
 #include "EapTimeCalibration.h"
 #include "UiMediator.h"
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QFile>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QCoreApplication>
 #include <QSettings>
@@ -16,6 +17,8 @@
 #include <ubAbstractController.h>
 #include "ubcontext.h"
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <future>
 
 #include "JsonBuilder.h"
 #include "JsonParser.h"
@@ -27,11 +30,6 @@ using namespace EapConstants;
 
 // 占位符: ${now:fmt} / ${global:key} / ${msg:key} / ${var:key}
 
-// 快速拿到“当前时间的字符串表示”
-static QString expandNow(const QString& fmt) {
-	return QDateTime::currentDateTime().toString(fmt.isEmpty() ? DEFAULT_DATETIME_FORMAT : fmt);
-}
-
 EapManager::EapManager(QWidget* parent)
 	: ubUiBase(parent), m_manager(new EAPInterfaceManager(this))
 {
@@ -39,52 +37,111 @@ EapManager::EapManager(QWidget* parent)
 	const QString appPath = QCoreApplication::applicationDirPath();
 	REGIST_LOG_TYPE(EAPMANAGER_LOG, EAPMANAGER_LOG);
 
-	// 加载初始参数 & 接口配置 & 映射参数
-	if (!loadInitialParams(appPath + "/config/eap/eap.ini")) {
+	// 启动分阶段计时：结束时输出一行“阶段=耗时”，便于跟踪启动耗时回退
+	QElapsedTimer startupClock;
+	QElapsedTimer phaseClock;
+	startupClock.start();
+	phaseClock.start();
+	QStringList startupPhases;
+	auto phaseDone = [&startupPhases, &phaseClock](const QString& phase) {
+		startupPhases << QString("%1=%2ms").arg(phase).arg(phaseClock.restart());
+	};
+	// 后台加载任务：返回（错误信息，耗时 ms），错误信息为空表示成功；日志统一回到本线程输出
+	using StartupResult = QPair<QString, qint64>;
+	auto runTimed = [](std::function<QString()> load) {
+		return std::async(std::launch::async, [load]() {
+			QElapsedTimer t;
+			t.start();
+			const QString err = load();
+			return StartupResult(err, t.elapsed());
+		});
+	};
+
+	// 加载初始参数：其余配置文件路径均来自 eap.ini，须最先完成
+	const bool iniLoaded = loadInitialParams(appPath + "/config/eap/eap.ini");
+	if (!iniLoaded) {
 		QString msg = QObject::tr("EAP/MES加载配置文件失败");
 		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, msg.toLocal8Bit().data());
 	}
-	else {
-		if (!m_manager->loadInterfaceConfig(m_interfaceFilePath)) { // m_interfaceFilePath：/config/eap/config_interfaces.merged.json
-			QString msg = QObject::tr("EAP/MES加载接口文档失败");
-			cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, msg.toLocal8Bit().data());
-		}
-		if (!loadDeviceRequestParams(appPath + "/config/eap/infoMap.json", m_mapParams)) {
-			QString msg = QObject::tr("EAP/MES加载映射参数文档失败");
-			cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, msg.toLocal8Bit().data());
-		}
-	}
-
-	// 新增：加载 Envelope 策略 + Header 参数（便于新 MES 头/外壳兼容）
-	m_manager->loadEnvelopePolicy(m_payloadParamFilePath); // m_payloadParamFilePath：/config/eap/payload_policy.json
-	m_manager->loadHeaderParams(m_headerParamFilePath); // m_headerParamFilePath：/config/eap/config_header_params.json
-
-	// 新增：加载路由（可选，不存在则忽略）
-	loadRoutes(appPath + "/config/eap/routes.json");
+	phaseDone("ini");
+
+	// 相互独立的配置并发加载：各任务只写各自的对象，本线程在使用前等待对应任务完成
+	m_service = new EAPWebService(this); // 被 MES 调用的服务端
+	QMap<QString, QVariantMap> mapParams;
+	auto upstreamTask = runTimed([this, iniLoaded]() -> QString {
+		// 上行接口配置 + Envelope 策略 + Header 参数（同一对象，任务内顺序执行）
+		QString err;
+		if (iniLoaded && !m_manager->loadInterfaceConfig(m_interfaceFilePath)) // m_interfaceFilePath：/config/eap/config_interfaces.merged.json
+			err = QObject::tr("EAP/MES加载接口文档失败");
+		m_manager->loadEnvelopePolicy(m_payloadParamFilePath); // m_payloadParamFilePath：/config/eap/payload_policy.json
+		m_manager->loadHeaderParams(m_headerParamFilePath); // m_headerParamFilePath：/config/eap/config_header_params.json
+		return err;
+	});
+	auto infoMapTask = runTimed([this, iniLoaded, appPath, &mapParams]() -> QString {
+		if (iniLoaded && !loadDeviceRequestParams(appPath + "/config/eap/infoMap.json", mapParams))
+			return QObject::tr("EAP/MES加载映射参数文档失败");
+		return QString();
+	});
+	auto downstreamTask = runTimed([this]() -> QString {
+		QStringList errs;
+		if (!m_service->loadInterfaceConfig(m_serviceInterfaceFilePath)) // m_serviceInterfaceFilePath：/config/eap/config_interfaces.downstream.merged.json
+			errs << QString("加载下发接口配置失败: %1").arg(m_service->lastError());
+		// 统一外壳策略
+		QString envErr;
+		if (!m_service->loadEnvelopePolicy(m_payloadParamFilePath, &envErr)) // m_payloadParamFilePath：/config/eap/payload_policy.json
+			errs << QString("加载外壳策略失败: %1").arg(envErr);
+		return errs.join("; ");
+	});
+	auto routesTask = runTimed([this, appPath]() -> QString {
+		loadRoutes(appPath + "/config/eap/routes.json"); // 可选，不存在则忽略
+		return QString();
+	});
+	auto defaultsTask = runTimed([this]() -> QString {
+		loadDefaultParam(); // /config/eap/default_params.json
+		return QString();
+	});
 
-	// 创建上传队列管理器
+	// 接口测试参数常驻内存，文件变化时才重新加载
+	watchInterfaceParamsFile();
+
+	// 周期上报（心跳、时间同步）统一由调度器管理
+	m_reportScheduler = new EapReportScheduler(this);
+	registerPeriodicReports();
+
+	// CIM 消息通知中心：应答立即返回，消息排队到 GUI 线程合并显示
+	m_notificationCenter = new EapNotificationCenter(this, this);
+	m_notificationCenter->setMaxOpenDialogs(m_maxCimDialogs);
+	connect(m_notificationCenter, &EapNotificationCenter::confirmed, this, [](const QString& message, int count) {
+		QString confirmMsg = QString("CIM 消息已确认: %1, 合并条数: %2").arg(message).arg(count);
+		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, confirmMsg.toLocal8Bit().data());
+		});
+	connect(m_notificationCenter, &EapNotificationCenter::dropped, this, [](const QString& message, int count) {
+		QString dropMsg = QString("CIM 消息排队溢出已丢弃: %1, 合并条数: %2").arg(message).arg(count);
+		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, dropMsg.toLocal8Bit().data());
+		});
+
+	// 告警聚合：只上报防抖后的状态变化，可合并的接口一次上报多条
+	m_alarmAggregator = new EapAlarmAggregator(this);
+	m_alarmAggregator->setDebounceMs(m_alarmDebounceMs);
+	m_alarmAggregator->setMaxBatch(m_alarmBatchMax);
+	connect(m_alarmAggregator, &EapAlarmAggregator::transitionsReady, this, &EapManager::onAlarmTransitions);
+
+	// 创建上传队列管理器（队列库在首次使用时打开）
 	m_uploadQueueManager = new EAPUploadQueueManager(m_manager, this);
 
-	// 1) 创建 WebService（被 MES 调用的服务端）
-	m_service = new EAPWebService(this);
-
-	if (!m_service->loadInterfaceConfig(m_serviceInterfaceFilePath)) { // m_serviceInterfaceFilePath：/config/eap/config_interfaces.downstream.merged.json
-		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, QString("加载下发接口配置失败: %1").arg(m_service->lastError()).toLocal8Bit().data());
-	}
-	// 3) 统一外壳策略
-	QString envErr;
-	if (!m_service->loadEnvelopePolicy(m_payloadParamFilePath, &envErr)) { // m_payloadParamFilePath：/config/eap/payload_policy.json
-		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, QString("加载外壳策略失败: %1").arg(envErr).toLocal8Bit().data());
-	}
+	// 上报分发：离线缓存总开关 + 各接口离线 / 半自动配置
+	m_dispatcher.reset(new EAPDispatcher(m_manager));
+	m_dispatcher->setCacheEnabled(m_isCacheData);
+	m_dispatcher->setMode(m_isOnline ? EAPDispatcher::Mode::Online : EAPDispatcher::Mode::Offline);
+	// 队列补传同样受半自动模式限制：未允许的接口记录留在队列中，切回在线后再补传
+	m_uploadQueueManager->setSendFilter([this](const QString& interfaceKey) {
+		return m_dispatcher->allowsReplay(interfaceKey);
+	});
 
-	// 创建数据缓存并注入 manager/service
+	// 创建数据缓存（各库在首次读写时打开）
 	m_data_cache = new EAPDataCache(this);
 	m_data_cache->initialize("./dataCache");
-	m_service->setDataCache(m_data_cache);
-	m_manager->setDataCache(m_data_cache);
-
-	// 加载默认参数 /config/eap/default_params.json
-	loadDefaultParam();
+	phaseDone("objects");
 
 	// 连接信号：内部消息发送，收到消息，进行广播
 	connect(this, &EapManager::sigMessage, this, &EapManager::handleSendMessage, Qt::QueuedConnection);
@@ -120,17 +177,12 @@ EapManager::EapManager(QWidget* parent)
 		}
 		else if (fn == INTERFACE_CIMMODE_CHANGE_COMMAND) // constexpr const char* INTERFACE_CIMMODE_CHANGE_COMMAND = "CIMModeChangeCommand"
 		{
-			// 处理 CIM 模式切换命令
-
-			//QMetaObject::invokeMethod(this, [this, fn, reqJson, req, &out]() mutable {
-			//    handleCimModeChangeCommand(fn, reqJson, req, out);
-			//    }, Qt::QueuedConnection);
-
+			// 处理 CIM 模式切换命令（经 asyncResponder 在 GUI 线程执行）
 			handleCimModeChangeCommand(fn, reqJson, req, out);
 		}
 		else if (fn == INTERFACE_LOTCOMMAND_DOWNLOAD) // constexpr const char* INTERFACE_LOTCOMMAND_DOWNLOAD = "LotCommandDownload";
 		{
-			// 处理批次命令下载
+			// 处理批次命令下载（经 asyncResponder 在 GUI 线程执行）
 			handleLotCommandDownload(fn, reqJson, req, out);
 		}
 		else if (fn == INTERFACE_PRODUCTIONINFODOWNLOAD) // constexpr const char* INTERFACE_PRODUCTIONINFODOWNLOAD = "ProductionInfoDownload";
@@ -142,8 +194,8 @@ EapManager::EapManager(QWidget* parent)
 		return out;
 	};
 
-	// 设置 rawResponder：把本地字段映射为真正 JSON 响应
-	m_service->setRawResponder([this, provider](const QString& fn, const QJsonObject& reqJson, const QVariantMap& mappedReq) -> QJsonObject {
+	// 把本地字段映射为真正 JSON 响应（同步 / 异步回调共用）
+	auto respond = [this, provider](const QString& fn, const QJsonObject& reqJson, const QVariantMap& mappedReq) -> QJsonObject {
 		QJsonObject out;
 		// 取 meta，用 response_mapping 里 body.* 反向构 body
 		const EapInterfaceMeta* meta = m_service->getMeta(fn);
@@ -189,15 +241,55 @@ EapManager::EapManager(QWidget* parent)
 		if (!body.isEmpty()) out.insert(JSON_BODY, body);
 
 		return out;
+	};
+
+	// 设置 asyncResponder：需要操作界面/定时器的接口投递到 GUI 线程处理，完成后再响应，
+	// HTTP 线程不再额外起线程阻塞等待
+	m_service->setAsyncResponder([this, respond](const QString& fn, const QJsonObject& reqJson, const QVariantMap& mappedReq,
+		EAPResponseHandle handle) -> bool {
+		if (fn != INTERFACE_CIMMODE_CHANGE_COMMAND && fn != INTERFACE_LOTCOMMAND_DOWNLOAD)
+			return false;
+		QMetaObject::invokeMethod(this, [respond, fn, reqJson, mappedReq, handle]() {
+			if (handle.isDone()) // 已超时或服务已停止
+				return;
+			handle.finish(respond(fn, reqJson, mappedReq));
+			}, Qt::QueuedConnection);
+		return true;
 	});
 
-	// 启动 WebService
+	// 设置 rawResponder
+	m_service->setRawResponder(respond);
+
+	// 等待并发加载完成（记录各任务自身耗时，与上面的阶段重叠）
+	auto joinTask = [&startupPhases](const char* name, std::future<StartupResult>& task) {
+		const StartupResult r = task.get();
+		startupPhases << QString("%1=%2ms").arg(name).arg(r.second);
+		if (!r.first.isEmpty())
+			cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, r.first.toLocal8Bit().data());
+	};
+	joinTask("upstream", upstreamTask);
+	joinTask("infoMap", infoMapTask);
+	joinTask("downstream", downstreamTask);
+	joinTask("routes", routesTask);
+	joinTask("defaults", defaultsTask);
+	m_mapParams = mapParams;
+	phaseDone("join");
+
+	// 注入数据缓存（加载完成后再改动 manager/service）
+	m_service->setDataCache(m_data_cache);
+	m_manager->setDataCache(m_data_cache);
+
+	// 配置就绪后立即启动 WebService（处理函数会用到上行接口与映射参数，须在全部加载完成后）
 	if (m_service->isValid() && !m_service->start(8026, "0.0.0.0")) {
 		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::warn, QString("EAPWebService 启动失败: %1").arg(m_service->lastError()).toLocal8Bit().data());
 	}
 	else {
 		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, "EAPWebService started on 0.0.0.0:8026");
 	}
+	phaseDone("webservice");
+
+	const QString startupReport = QString("EapManager 启动耗时 %1ms: %2").arg(startupClock.elapsed()).arg(startupPhases.join(", "));
+	cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, startupReport.toLocal8Bit().data());
 
 	// 离线测试代码
 	// 离线测试信号连接
@@ -219,6 +311,27 @@ void EapManager::loadDefaultParam()
 	ParameterHelper::loadDefaultParam(m_defaultReturnParamFilePath);
 }
 
+/**
+ * @brief 登记周期上报任务
+ *
+ * 任务 id 即接口键名，onRequestSuccess / onRequestFailed 据此回写最近一次结果。
+ * 任务只在这里登记一次；上线/重连时只 start，不会叠加触发。
+ */
+void EapManager::registerPeriodicReports()
+{
+	// 心跳
+	m_reportScheduler->registerJob(INTERFACE_HEARTBEAT, m_heartBeatTime, [this]() {
+		QVariantMap statusMap = creatMapParams(INTERFACE_HEARTBEAT);
+		post(INTERFACE_HEARTBEAT, statusMap);
+		}, m_reportJitterPercent);
+
+	// 时间同步：每次触发重新取当前时间
+	m_reportScheduler->registerJob(FIELD_CURRENT_TIME, m_synTimeTime, [this]() {
+		QVariantMap map = creatMapParams(FIELD_CURRENT_TIME);
+		post(FIELD_CURRENT_TIME, map);
+		}, m_reportJitterPercent);
+}
+
 /**
  * @brief 发送用户校验状态消息
  * @param msg 原始的用户校验消息内容（不要求包含 topic 字段）
@@ -239,9 +352,7 @@ void EapManager::onUserChanged(int level) {
  */
 void EapManager::onModelChanged(QString modelName)
 {
-	if (!m_isOnline) return;
-	QVariantMap map = creatMapParams(INTERFACE_EQUIPMENT_INFORMATION);
-	post(INTERFACE_EQUIPMENT_INFORMATION, map);
+	dispatch(INTERFACE_EQUIPMENT_INFORMATION, [this]() { return creatMapParams(INTERFACE_EQUIPMENT_INFORMATION); });
 }
 
 void EapManager::onListMsg(QString& topic, QVariantList& list) {
@@ -261,16 +372,8 @@ void EapManager::onStructMsg(QString& topic, QVariantMap& msg)
 	// 0) 优先按路由配置处理（新增）
 	if (m_topicRoutes.contains(topic)) {
 		const RouteRule& r = m_topicRoutes[topic];
-		QVariantMap params = buildParamsFromTemplate(r.paramTemplate, msg);
-		if (r.useQueue) {
-			// 入队上传（离线缓存等）
-			if (m_isOnline || m_isCacheData) {
-				m_uploadQueueManager->submit(r.interfaceKey, params);
-			}
-		}
-		else {
-			if (m_isOnline) post(r.interfaceKey, params);
-		}
+		// 分发器决定直接发送 / 入队（离线缓存等）/ 丢弃，丢弃时不展开模板
+		dispatch(r.interfaceKey, [&]() { return buildParamsFromTemplate(r, msg); }, r.useQueue);
 		// 命中路由后直接返回，避免重复走旧逻辑
 		return;
 	}
@@ -279,13 +382,14 @@ void EapManager::onStructMsg(QString& topic, QVariantMap& msg)
 	if (topic == TOPIC_ONLINE_STATUS_CHANGE) { // 在线状态变化主题 - 设备上线/离线时触发
 		if (msg.contains(FIELD_STATUS)) {
 			bool status = msg[FIELD_STATUS].toBool();
-			// 在线离线 切换
+			// 在线离线 切换（本地切换上报的是在线 / 离线模式，不再是半自动）
+			setCimSemiAuto(false);
 			if (status) {
 				setConnection(true);
 				if (isInerfaceEnabled(INTERFACE_HEARTBEAT)) {
 					QVariantMap statusMap = creatMapParams(INTERFACE_HEARTBEAT); // 根据接口名构造标准上报参数
 					post(INTERFACE_HEARTBEAT, statusMap); // 发送指定接口的请求
-					m_heartBeatTimer.start(m_heartBeatTime);
+					m_reportScheduler->start(INTERFACE_HEARTBEAT);
 				}
 				else {
 					setOnlineStatus(true);
@@ -333,22 +437,20 @@ void EapManager::onStructMsg(QString& topic, QVariantMap& msg)
 		}
 	}
 	else if (topic == TOPIC_EQP_STATUS_CHANGED) { // 设备状态变化主题 - 设备状态改变时触发（运行/停止/急停等）
-		if (!m_isOnline) return;
 		if (msg.contains(FIELD_STATUS)) {
 			QString status = msg[FIELD_STATUS].toString();
 			m_deviceStatus = status;
-			QVariantMap statusMap = creatMapParams(INTERFACE_EQUIPMENT_STATUS);
-			post(INTERFACE_EQUIPMENT_STATUS, statusMap);
+			dispatch(INTERFACE_EQUIPMENT_STATUS, [this]() { return creatMapParams(INTERFACE_EQUIPMENT_STATUS); });
 
-			if (m_alarmStatus == STATUS_OCCURRENCE) {
+			if (m_isOnline && m_alarmStatus == STATUS_OCCURRENCE) {
 				m_alarmStatus = STATUS_CLEAR;
 				QVariantMap a = creatMapParams(INTERFACE_ALARM_WARNING);
 				post(INTERFACE_ALARM_WARNING, a);
+				m_alarmAggregator->setReportedState(m_alarmCode, STATUS_CLEAR); // 同步告警状态表
 			}
 
-			
-			QVariantMap realstatus = creatMapParams("StatusChangeReport");
-			post("StatusChangeReport",statusMap);
+			// StatusChangeReport 沿用设备状态接口的参数
+			dispatch("StatusChangeReport", [this]() { return creatMapParams(INTERFACE_EQUIPMENT_STATUS); });
 		}
 	}
 	else if (topic == TOPIC_DOWNLOAD_PROCESS_DATA) { // 下载工艺数据主题 - 从 MES 下载工艺参数
@@ -370,37 +472,31 @@ void EapManager::onStructMsg(QString& topic, QVariantMap& msg)
 		post(INTERFACE_DOWNLOAD_PROCESS_DATA, msg);
 	}
 	else if (topic == TOPIC_UPLOAD_PROCESS_DATA) { // 上传工艺数据主题 - 向 MES 上传工艺数据
-		if (!m_isOnline && !m_isCacheData) return;
-		if (!msg.contains(FIELD_PROCESS_STEP_MANUAL) || msg[FIELD_PROCESS_STEP_MANUAL].toString().isEmpty()) {
-			m_process_manual = UiMediator::instance()->getController()->context()->getGlobal(FIELD_PROCESS_STEP_MANUAL).toString();
-			msg[FIELD_PROCESS_STEP_MANUAL] = m_process_manual;
-		}
-		m_uploadQueueManager->submit(INTERFACE_UPLOAD_PROCESS_DATA, msg);
+		dispatch(INTERFACE_UPLOAD_PROCESS_DATA, [&]() {
+			if (!msg.contains(FIELD_PROCESS_STEP_MANUAL) || msg[FIELD_PROCESS_STEP_MANUAL].toString().isEmpty()) {
+				m_process_manual = UiMediator::instance()->getController()->context()->getGlobal(FIELD_PROCESS_STEP_MANUAL).toString();
+				msg[FIELD_PROCESS_STEP_MANUAL] = m_process_manual;
+			}
+			return msg;
+			}, true);
 	}
 	else if (topic == TOPIC_UPLOAD_PANEL_DATA) { // 上传面板数据主题 - 向 MES 上传面板信息
-		if (!m_isOnline && !m_isCacheData) return;
-		if (!msg.contains(FIELD_PROCESS_STEP_MANUAL) || msg[FIELD_PROCESS_STEP_MANUAL].toString().isEmpty()) {
-			m_process_manual = UiMediator::instance()->getController()->context()->getGlobal(FIELD_PROCESS_STEP_MANUAL).toString();
-			msg[FIELD_PROCESS_STEP_MANUAL] = m_process_manual;
-			msg[INI_KEY_PROCESS] = m_process;
-			msg[INI_KEY_DEVICE_PLACE] = m_devicePlace;
-			msg[INI_KEY_DEVICE_ID] = m_deviceId;
-		}
-		m_uploadQueueManager->submit(INTERFACE_UPLOAD_PANEL_DATA, msg);
+		dispatch(INTERFACE_UPLOAD_PANEL_DATA, [&]() {
+			if (!msg.contains(FIELD_PROCESS_STEP_MANUAL) || msg[FIELD_PROCESS_STEP_MANUAL].toString().isEmpty()) {
+				m_process_manual = UiMediator::instance()->getController()->context()->getGlobal(FIELD_PROCESS_STEP_MANUAL).toString();
+				msg[FIELD_PROCESS_STEP_MANUAL] = m_process_manual;
+				msg[INI_KEY_PROCESS] = m_process;
+				msg[INI_KEY_DEVICE_PLACE] = m_devicePlace;
+				msg[INI_KEY_DEVICE_ID] = m_deviceId;
+			}
+			return msg;
+			}, true);
 	}
 	else if (topic == TOPIC_ALARM_WARNING) { // 告警主题 - 设备告警或警告时触发
 		if (!m_isOnline) return;
 		if (msg.contains(FIELD_CODE) && msg.contains(FIELD_STATUS)) {
-			m_alarmCode = msg[FIELD_CODE].toString();
-			m_alarmStatus = msg[FIELD_STATUS].toString();
-			QVariantMap a = creatMapParams(INTERFACE_ALARM_WARNING);
-			post(INTERFACE_ALARM_WARNING, a);
-
-			if (m_alarmStatus == STATUS_OCCURRENCE) {
-				m_deviceStatus = STATUS_EMG;
-				QVariantMap s = creatMapParams(INTERFACE_EQUIPMENT_STATUS);
-				post(INTERFACE_EQUIPMENT_STATUS, s);
-			}
+			// 经告警聚合器防抖、去重后在 onAlarmTransitions 中上报
+			m_alarmAggregator->submit(msg[FIELD_CODE].toString(), msg[FIELD_STATUS].toString());
 		}
 	}
 	else if (topic == TOPIC_USER_LEVEL_CHANGED) { // 用户等级变化主题 - 用户登录/登出时触发
@@ -473,11 +569,57 @@ bool EapManager::loadDeviceRequestParams(const QString& filename, QMap<QString,
  * @brief 获取指定接口的参数配置
  * @param interfaceName 接口名/接口键（如 "INTERFACE_EQUIPMENT_STATUS"）
  * @return 该接口对应的参数表，或空的 QVariantMap（当未找到时）
+ *
+ * 参数表常驻内存；仅在首次使用或测试数据文件变化后从文件重新加载一次。
  */
-QVariantMap EapManager::getParamsFor(const QString& interfaceName) const {
+QVariantMap EapManager::getParamsFor(const QString& interfaceName) {
+	QMutexLocker locker(&m_paramsMutex);
+	if (m_interfaceParamsDirty) {
+		// 加载失败（文件缺失、正在写入等）时保留旧参数与失效标志，下次使用时再试
+		QMap<QString, QVariantMap> loaded;
+		if (loadDeviceRequestParams(m_testPostDataFilePath, loaded)) {
+			m_interfaceParams.swap(loaded);
+			m_interfaceParamsDirty = false;
+		}
+	}
 	return m_interfaceParams.value(interfaceName);
 }
 
+/**
+ * @brief 监视测试数据文件（m_testPostDataFilePath），变化时使接口参数缓存失效
+ *
+ * 编辑器保存文件常以“写新文件再替换”的方式进行，替换后原路径会从监视列表中移除；
+ * 文件也可能在启动时尚不存在。因此同时监视所在目录：目录变化时若文件存在且未被监视，
+ * 重新加入监视并使缓存失效。
+ */
+void EapManager::watchInterfaceParamsFile()
+{
+	if (m_testPostDataFilePath.isEmpty()) return;
+	const QString filePath = QFileInfo(m_testPostDataFilePath).absoluteFilePath();
+	const QString dirPath = QFileInfo(filePath).absolutePath();
+	if (QFile::exists(filePath))
+		m_paramsFileWatcher.addPath(filePath);
+	if (QFileInfo(dirPath).isDir())
+		m_paramsFileWatcher.addPath(dirPath);
+
+	auto invalidate = [this]() {
+		QMutexLocker locker(&m_paramsMutex);
+		m_interfaceParamsDirty = true;
+	};
+	connect(&m_paramsFileWatcher, &QFileSystemWatcher::fileChanged, this, [this, invalidate](const QString& path) {
+		invalidate();
+		if (QFile::exists(path) && !m_paramsFileWatcher.files().contains(path))
+			m_paramsFileWatcher.addPath(path);
+	});
+	connect(&m_paramsFileWatcher, &QFileSystemWatcher::directoryChanged, this, [this, invalidate, filePath](const QString&) {
+		// 文件被替换或新建后重新加入监视；已在监视中的修改由 fileChanged 处理
+		if (QFile::exists(filePath) && !m_paramsFileWatcher.files().contains(filePath)) {
+			m_paramsFileWatcher.addPath(filePath);
+			invalidate();
+		}
+	});
+}
+
 /**
  * @brief 从 ini 配置文件加载 EAP/MES 初始参数
  * @param filename ini 配置文件的完整路径
@@ -512,7 +654,21 @@ bool EapManager::loadInitialParams(const QString& filename)
 	settings.beginGroup(INI_GROUP_INTERFACE);
 	m_heartBeatTime = settings.value(INI_KEY_HEART_BEAT_TIME, 60000).toInt(); // 心跳时间间隔
 	m_synTimeTime = settings.value(INI_KEY_SYN_TIME_TIME, 3600000).toInt(); // 时间同步间隔
+	m_reportJitterPercent = settings.value(INI_KEY_REPORT_JITTER_PERCENT, 10).toInt(); // 周期上报抖动幅度
+	m_maxCimDialogs = settings.value(INI_KEY_MAX_CIM_DIALOGS, 3).toInt(); // CIM 对话框上限
+	m_alarmDebounceMs = settings.value(INI_KEY_ALARM_DEBOUNCE_MS, 200).toInt(); // 告警防抖时间
+	m_alarmBatchMax = settings.value(INI_KEY_ALARM_BATCH_MAX, 50).toInt(); // 告警合并上限
 	m_isCacheData = settings.value(INI_KEY_OFFLINE_CACHE, false).toBool(); // 离线缓存开关
+	{
+		// MES 通讯日志级别：调为 info 及以上时，LOG_TYPE_DEBUG_ENABLED("MES") 为 false，报文调试副本不再序列化
+		const QString level = settings.value(INI_KEY_MES_LOG_LEVEL, "debug").toString().trimmed().toLower();
+		const myLog::logLevel mesLevel = level == "error" ? myLog::logLevel::lv_error
+			: level == "warn" ? myLog::logLevel::lv_warn
+			: level == "info" ? myLog::logLevel::lv_info
+			: myLog::logLevel::lv_debug;
+		LOG_TYPE_SET_LEVEL("MES", mesLevel);
+		LOG_TYPE_SET_LEVEL(EAPMANAGER_LOG, mesLevel);
+	}
 	m_token = settings.value(INI_KEY_TOKEN, VALUE_EMPTY).toString(); // 令牌
 	settings.endGroup();
 
@@ -542,16 +698,22 @@ void EapManager::setGlobal(QString name, QVariant var)
 bool EapManager::setOnlineStatus(bool status)
 {
 	// P0: 线程安全
+	bool semiAuto = false;
 	{
 		QMutexLocker locker(&m_stateMutex);
 		m_isOnline = status;
+		semiAuto = m_cimSemiAuto;
 	}
+	// 在线时按 CIM 控制模式恢复 Semi-Auto，链路断开重连不会丢失半自动限制
+	if (m_dispatcher)
+		m_dispatcher->setMode(!status ? EAPDispatcher::Mode::Offline
+			: (semiAuto ? EAPDispatcher::Mode::SemiAuto : EAPDispatcher::Mode::Online));
 
 	setGlobal(GLOBAL_ONLINE_STATUS, m_isOnline);
 
 	if (!m_isOnline) {
-		m_heartBeatTimer.stop();
-		m_synTimeTimer.stop();
+		m_reportScheduler->stopAll();
+		m_alarmAggregator->clear(); // 离线期间不上报告警，重新上线后按新状态重新开始
 		setConnection(false);
 		m_uploadQueueManager->stop();
 	}
@@ -561,6 +723,25 @@ bool EapManager::setOnlineStatus(bool status)
 	return true;
 }
 
+/**
+ * @brief 记录 CIM 控制模式是否为半自动
+ * @param on true 表示半自动（Semi-Auto），false 表示在线 / 离线
+ *
+ * 控制模式与链路在线状态（m_isOnline）分开保存；当前在线时立即切换分发模式，
+ * 离线时只记录，待 setOnlineStatus(true) 时恢复。
+ */
+void EapManager::setCimSemiAuto(bool on)
+{
+	bool online = false;
+	{
+		QMutexLocker locker(&m_stateMutex);
+		m_cimSemiAuto = on;
+		online = m_isOnline;
+	}
+	if (online && m_dispatcher)
+		m_dispatcher->setMode(on ? EAPDispatcher::Mode::SemiAuto : EAPDispatcher::Mode::Online);
+}
+
 /**
  * @brief 发送指定接口的请求（带默认参数、时间与 token 自动补全）
  * @param interfaceKey MES/EAP 接口键名（需在接口配置中存在且为 PUSH 方向）
@@ -568,11 +749,11 @@ bool EapManager::setOnlineStatus(bool status)
  */
 void EapManager::post(const QString& interfaceKey, const QVariantMap& params)
 {
-	if (!m_manager->getInterfaceKeys().contains(interfaceKey)) return;
+	const EapInterfaceMeta* found = m_manager->findInterface(interfaceKey);
+	if (!found) return;
 
-	loadDeviceRequestParams(m_testPostDataFilePath, m_interfaceParams);
-	const QString key = interfaceKey;
-	EapInterfaceMeta meta = m_manager->getInterface(key);
+	const QString& key = interfaceKey;
+	const EapInterfaceMeta& meta = *found;
 	if (!meta.enabled || meta.direction != DIRECTION_PUSH) return;
 
 	QVariantMap paramsTmp = params;
@@ -597,6 +778,93 @@ void EapManager::post(const QString& interfaceKey, const QVariantMap& params)
 	m_manager->post(key, paramsTmp);
 }
 
+/**
+ * @brief 按当前 CIM 模式与接口的 offlineEnabled / offlineCache / semiAutoEnabled 分发一次上报
+ * @param interfaceKey 上行接口键名
+ * @param build        组包函数，只在需要发送或入队时调用
+ * @param preferQueue  在线时经上传队列发送（可补传的上报）；接口未配置离线字段时也作为离线缓存依据
+ * @return true 表示已发送或入队，false 表示按策略丢弃
+ */
+bool EapManager::dispatch(const QString& interfaceKey, const std::function<QVariantMap()>& build, bool preferQueue)
+{
+	const EAPDispatcher::Route route = m_dispatcher->route(interfaceKey, preferQueue);
+	if (route == EAPDispatcher::Route::Drop)
+		return false;
+
+	if (route == EAPDispatcher::Route::Queue)
+		m_uploadQueueManager->submit(interfaceKey, build());
+	else
+		post(interfaceKey, build());
+	return true;
+}
+
+/**
+ * @brief 告警聚合器给出一批到期的状态变化时上报
+ * @param transitions 按出现先后排序的告警状态变化
+ *
+ * 告警接口 body 映射中配置了 FIELD_ALARM_LIST 时，多条变化合并为一次上报：
+ * 列表元素按该接口单条告警字段的映射构建，单条字段保留最新一条（兼容只读单条字段的 MES）；
+ * 否则逐条上报。有告警发生时设备状态只上报一次。
+ */
+void EapManager::onAlarmTransitions(const QList<EapAlarmAggregator::Transition>& transitions)
+{
+	if (!m_isOnline || transitions.isEmpty()) return;
+
+	int suppressed = 0;
+	bool occurred = false;
+	for (const auto& t : transitions) {
+		suppressed += t.suppressed;
+		occurred = occurred || (t.status == STATUS_OCCURRENCE);
+	}
+
+	const EapInterfaceMeta* meta = m_manager->findInterface(INTERFACE_ALARM_WARNING);
+	if (meta && transitions.size() > 1 && meta->bodyMap.contains(FIELD_ALARM_LIST)) {
+		// 列表元素只包含单条告警字段
+		static const QStringList itemKeys = { FIELD_ALARM_CODE, FIELD_ALARM_TEXT, FIELD_ALARM_STATUS, FIELD_ALARM_LEVEL, FIELD_DATETIME };
+		EapInterfaceMeta itemMeta = *meta;
+		itemMeta.name.clear(); // 不合并接口默认参数
+		itemMeta.enableHeader = false;
+		itemMeta.bodyMap.clear();
+		for (const QString& k : itemKeys) {
+			if (meta->bodyMap.contains(k))
+				itemMeta.bodyMap.insert(k, meta->bodyMap.value(k));
+		}
+
+		QVariantList items;
+		QVariantMap params;
+		for (const auto& t : transitions) {
+			m_alarmCode = t.code;
+			m_alarmStatus = t.status;
+			params = creatMapParams(INTERFACE_ALARM_WARNING);
+			params[FIELD_DATETIME] = t.time.toString(DEFAULT_DATETIME_FORMAT); // 以变化出现的时间为准
+			items.append(JsonBuilder::buildPayload(itemMeta, params).value(JSON_BODY).toObject().toVariantMap());
+		}
+		params[FIELD_ALARM_LIST] = items;
+		post(INTERFACE_ALARM_WARNING, params);
+	}
+	else {
+		for (const auto& t : transitions) {
+			m_alarmCode = t.code;
+			m_alarmStatus = t.status;
+			QVariantMap a = creatMapParams(INTERFACE_ALARM_WARNING);
+			a[FIELD_DATETIME] = t.time.toString(DEFAULT_DATETIME_FORMAT);
+			post(INTERFACE_ALARM_WARNING, a);
+		}
+	}
+
+	if (occurred) {
+		m_deviceStatus = STATUS_EMG;
+		QVariantMap s = creatMapParams(INTERFACE_EQUIPMENT_STATUS);
+		post(INTERFACE_EQUIPMENT_STATUS, s);
+	}
+
+	if (suppressed > 0) {
+		QString msg = QString("告警上报 %1 条状态变化，抑制重复/闪断消息 %2 条（累计抑制 %3 条）")
+			.arg(transitions.size()).arg(suppressed).arg(m_alarmAggregator->suppressedTotal());
+		cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, msg.toLocal8Bit().data());
+	}
+}
+
 /**
  * @brief 启用或关闭与 EAPInterfaceManager 的信号连接
  * @param status true 表示建立信号连接，false 表示断开信号连接
@@ -635,30 +903,25 @@ void EapManager::onRequestStarted(const QString& key, const QJsonObject& json)
  */
 void EapManager::onRequestSuccess(const QString& interfaceKey, const QJsonObject& result)
 {
+	m_reportScheduler->reportResult(interfaceKey, true); // 周期上报任务回写结果（其它接口忽略）
+
 	if (INTERFACE_HEARTBEAT == interfaceKey) {
 		if (!m_isOnline) {
 			setOnlineStatus(true);
 			QString s = tr("心跳请求成功，已切换到在线模式 [%1]").arg(QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Indented)));
 			cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, s.toLocal8Bit().data());
 
-			QVariantMap map = creatMapParams(FIELD_CURRENT_TIME);
-			post(FIELD_CURRENT_TIME, map);
-			connect(&m_synTimeTimer, &QTimer::timeout, this, [=]() {
-				post(FIELD_CURRENT_TIME, map);
-				});
-			m_synTimeTimer.start(m_synTimeTime);
+			// 时间同步：立即同步一次并开始周期调度
+			m_reportScheduler->start(FIELD_CURRENT_TIME, true);
 
-			map = creatMapParams(INTERFACE_INITIAL_DATA);
+			QVariantMap map = creatMapParams(INTERFACE_INITIAL_DATA);
 			post(INTERFACE_INITIAL_DATA, map);
 
 			map = creatMapParams(INTERFACE_EQUIPMENT_INFORMATION);
 			post(INTERFACE_EQUIPMENT_INFORMATION, map);
 
-			connect(&m_heartBeatTimer, &QTimer::timeout, this, [=]() {
-				QVariantMap statusMap = creatMapParams(INTERFACE_HEARTBEAT);
-				post(INTERFACE_HEARTBEAT, statusMap);
-				});
-			m_heartBeatTimer.start(m_heartBeatTime);
+			// 心跳任务已在构造时登记，重连只重新排期，不会叠加
+			m_reportScheduler->start(INTERFACE_HEARTBEAT);
 		}
 	}
 	else if (INTERFACE_DOWNLOAD_PROCESS_DATA == interfaceKey) {
@@ -733,6 +996,8 @@ void EapManager::onMappedResultReady(const QString& key, const QVariantMap& resu
  */
 void EapManager::onRequestFailed(const QString& interfaceKey, const QString& errorMsg)
 {
+	m_reportScheduler->reportResult(interfaceKey, false, errorMsg); // 周期上报任务回写结果（其它接口忽略）
+
 	if (INTERFACE_HEARTBEAT == interfaceKey) {
 		QString s;
 		if (!m_isOnline) {
@@ -872,9 +1137,8 @@ QVariantMap EapManager::creatMapParams(const QString& interfaceName)
  */
 bool EapManager::isInerfaceEnabled(const QString& interfaceName)
 {
-	if (!m_manager->getInterfaceKeys().contains(interfaceName)) return false;
-	EapInterfaceMeta meta = m_manager->getInterface(interfaceName);
-	return meta.enabled;
+	const EapInterfaceMeta* meta = m_manager->findInterface(interfaceName);
+	return meta && meta->enabled;
 }
 
 /**
@@ -931,8 +1195,10 @@ bool EapManager::loadRoutes(const QString& filename)
 		RouteRule rule;
 		rule.interfaceKey = r.value(INI_KEY_INTERFACE).toString();
 		rule.useQueue = r.value(JSON_QUEUE).toBool(false);
-		if (r.contains(JSON_PARAMS) && r.value(JSON_PARAMS).isObject())
-			rule.paramTemplate = r.value(JSON_PARAMS).toObject().toVariantMap();
+		// 参数模板在此编译为片段程序，收到消息时只做展开
+		const QVariantMap paramTemplate = (r.contains(JSON_PARAMS) && r.value(JSON_PARAMS).isObject())
+			? r.value(JSON_PARAMS).toObject().toVariantMap() : QVariantMap();
+		rule.params = compileTemplateValue(paramTemplate, rule.globalKeys);
 		if (!rule.interfaceKey.isEmpty())
 			m_topicRoutes.insert(topic, rule);
 	}
@@ -940,123 +1206,227 @@ bool EapManager::loadRoutes(const QString& filename)
 }
 
 /**
- * @brief 根据参数模板和消息内容展开占位符，生成最终请求参数
+ * @brief 把路由参数模板编译为片段程序（递归支持 map 和 list）
+ * @param in         模板值（字符串、map、list 或简单类型）
+ * @param globalKeys [in,out] 模板引用到的全局变量名，${global:key} 记录其下标
+ * @return 编译结果：不含占位符的字符串与其它标量为常量，字符串拆为片段序列
+ *
+ * 无法识别的 ${...}（含未知 ${var:key} 以外的写法）与未闭合的 "${" 按普通文本保留；
+ * 未知的 ${var:key} 展开为空字符串。
+ */
+EapManager::TemplateValue EapManager::compileTemplateValue(const QVariant& in, QStringList& globalKeys)
+{
+	TemplateValue out;
+	switch (in.userType()) {
+	case QMetaType::QString: {
+		const QString s = in.toString();
+		if (!s.contains(QLatin1String("${"))) {
+			out.constant = in;
+			return out;
+		}
+
+		QString literal;
+		bool hasPlaceholder = false;
+		auto flushLiteral = [&]() {
+			if (literal.isEmpty()) return;
+			TemplateToken t;
+			t.text = literal;
+			out.reserve += literal.size();
+			out.tokens.append(t);
+			literal.clear();
+		};
+
+		int pos = 0;
+		while (pos < s.size()) {
+			int start = s.indexOf(QLatin1String("${"), pos);
+			const int end = start < 0 ? -1 : s.indexOf(QLatin1Char('}'), start + 2);
+			if (end < 0) {
+				literal += s.midRef(pos);
+				break;
+			}
+			start = s.lastIndexOf(QLatin1String("${"), end);
+			literal += s.midRef(pos, start - pos);
+			const QString inner = s.mid(start + 2, end - start - 2);
+			pos = end + 1;
+
+			TemplateToken t;
+			if (inner.startsWith(QLatin1String("now:"))) {
+				t.kind = TemplateToken::Now;
+				const QString fmt = inner.mid(4);
+				t.text = fmt.isEmpty() ? QString(DEFAULT_DATETIME_FORMAT) : fmt;
+				out.reserve += t.text.size();
+			}
+			else if (inner.startsWith(QLatin1String("global:"))) {
+				const QString key = inner.mid(7);
+				int slot = globalKeys.indexOf(key);
+				if (slot < 0) {
+					slot = globalKeys.size();
+					globalKeys.append(key);
+				}
+				t.kind = TemplateToken::Global;
+				t.index = slot;
+				out.reserve += 16;
+			}
+			else if (inner.startsWith(QLatin1String("msg:"))) {
+				t.kind = TemplateToken::Msg;
+				t.text = inner.mid(4);
+				out.reserve += 16;
+			}
+			else if (inner.startsWith(QLatin1String("var:"))) {
+				static const QHash<QString, int> vars = {
+					{ QStringLiteral("device_id"), VarDeviceId },
+					{ QStringLiteral("device_ip"), VarDeviceIp },
+					{ QStringLiteral("process"), VarProcess },
+					{ QStringLiteral("process_manual"), VarProcessManual },
+					{ QStringLiteral("alarm_code"), VarAlarmCode },
+					{ QStringLiteral("alarm_status"), VarAlarmStatus },
+					{ QStringLiteral("status"), VarStatus },
+				};
+				const auto v = vars.constFind(inner.mid(4));
+				hasPlaceholder = true; // 即使为空也要输出展开后的字符串
+				if (v == vars.constEnd()) continue;
+				t.kind = TemplateToken::Var;
+				t.index = v.value();
+				out.reserve += 16;
+			}
+			else {
+				literal += s.midRef(start, end - start + 1);
+				continue;
+			}
+
+			flushLiteral();
+			out.tokens.append(t);
+			hasPlaceholder = true;
+		}
+		flushLiteral();
+
+		if (!hasPlaceholder) {
+			out.constant = in;
+			out.tokens.clear();
+			out.reserve = 0;
+			return out;
+		}
+		out.kind = TemplateValue::String;
+		return out;
+	}
+	case QMetaType::QVariantMap: {
+		out.kind = TemplateValue::Map;
+		const QVariantMap inMap = in.toMap();
+		out.keys.reserve(inMap.size());
+		out.children.reserve(inMap.size());
+		for (auto it = inMap.constBegin(); it != inMap.constEnd(); ++it) {
+			out.keys.append(it.key());
+			out.children.append(compileTemplateValue(it.value(), globalKeys));
+		}
+		return out;
+	}
+	case QMetaType::QVariantList: {
+		out.kind = TemplateValue::List;
+		const QVariantList inList = in.toList();
+		out.children.reserve(inList.size());
+		for (const auto& v : inList)
+			out.children.append(compileTemplateValue(v, globalKeys));
+		return out;
+	}
+	default:
+		out.constant = in;
+		return out;
+	}
+}
+
+/**
+ * @brief 根据路由规则的参数模板和消息内容展开占位符，生成最终请求参数
  * 示例：
  * @code
- * QVariantMap tmpl;
- * tmpl["trx_id"]    = "TRX_${now:yyyyMMddHHmmss}";
- * tmpl["device_id"] = "${var:device_id}";
- * tmpl["panel_id"]  = "${msg:panel_id}";
+ * // routes.json 中的 params：
+ * //  trx_id    = "TRX_${now:yyyyMMddHHmmss}";
+ * //  device_id = "${var:device_id}";
+ * //  panel_id  = "${msg:panel_id}";
  *
  * QVariantMap msg;
  * msg["panel_id"] = "PNL001";
  *
- * QVariantMap params = buildParamsFromTemplate(tmpl, msg);
+ * QVariantMap params = buildParamsFromTemplate(rule, msg);
  * // params 结果类似：
  * //  trx_id    = "TRX_20251202123045"
  * //  device_id = "EQP001"
  * //  panel_id  = "PNL001"
  * @endcode
  *
- * @param tmpl 参数模板（键名即最终参数名，值中可以包含占位符）
+ * @param rule 路由规则（参数模板已在 loadRoutes 时编译）
  * @param msg  当前消息内容，用于 ${msg:xxx} 占位符展开
  * @return 展开后的参数表，可直接用于调用 post()/uploadQueueManager->submit()
  */
-QVariantMap EapManager::buildParamsFromTemplate(const QVariantMap& tmpl,
+QVariantMap EapManager::buildParamsFromTemplate(const RouteRule& rule,
 	const QVariantMap& msg) const
 {
-	QVariantMap out;
-	for (auto it = tmpl.begin(); it != tmpl.end(); ++it) {
-		out.insert(it.key(), expandOneValue(it.value(), msg));
-	}
-	return out;
+	TemplateScratch scratch(msg, rule.globalKeys);
+	return evaluateTemplateValue(rule.params, scratch).toMap();
 }
 
 /**
- * @brief 对单个 QVariant 值进行占位符展开（递归支持 map 和 list）
- * @param in   输入的 QVariant 值（可能是字符串、map、list 或简单类型）
- * @param msg  当前消息内容，用于 ${msg:xxx} 占位符展开
- * @return     展开占位符后的 QVariant 值
+ * @brief 展开一个编译后的模板值（递归支持 map 和 list）
+ * @param v       compileTemplateValue 的结果
+ * @param scratch 本条消息的临时上下文（消息内容、已读取的全局变量、当前时间）
+ * @return        展开占位符后的 QVariant 值
  */
-QVariant EapManager::expandOneValue(const QVariant& in, const QVariantMap& msg) const
+QVariant EapManager::evaluateTemplateValue(const TemplateValue& v, TemplateScratch& scratch) const
 {
-	switch (in.userType()) {
-	case QMetaType::QString: {
-		QString s = in.toString();
-
-		// ${now:fmt}
-		int pos = 0;
-		while ((pos = s.indexOf("${now:", pos)) >= 0) {
-			int end = s.indexOf('}', pos);
-			if (end < 0) break;
-			const QString token = s.mid(pos, end - pos + 1);
-			const QString fmt = token.mid(6, token.size() - 7); // 去掉 ${now: 和 }
-			s.replace(token, expandNow(fmt));
-			pos = pos + 1;
-		}
-
-		// ${global:key}
-		int gpos = 0;
-		while ((gpos = s.indexOf("${global:", gpos)) >= 0) {
-			int end = s.indexOf('}', gpos);
-			if (end < 0) break;
-			const QString token = s.mid(gpos, end - gpos + 1);
-			const QString key = token.mid(9, token.size() - 10);
-			const QVariant v = UiMediator::instance()->getController()->context()->getGlobal(key);
-			s.replace(token, v.toString());
-			gpos = gpos + 1;
-		}
-
-		// ${msg:key}
-		int mpos = 0;
-		while ((mpos = s.indexOf("${msg:", mpos)) >= 0) {
-			int end = s.indexOf('}', mpos);
-			if (end < 0) break;
-			const QString token = s.mid(mpos, end - mpos + 1);
-			const QString key = token.mid(6, token.size() - 7);
-			s.replace(token, msg.value(key).toString());
-			mpos = mpos + 1;
-		}
-
-		// ${var:key} 来自 EapManager 成员
-		auto readVar = [&](const QString& k)->QString {
-			if (k == "device_id") return m_deviceId;
-			if (k == "device_ip") return m_deviceIp;
-			if (k == "process") return m_process;
-			if (k == "process_manual") return m_process_manual;
-			if (k == "alarm_code") return m_alarmCode;
-			if (k == "alarm_status") return m_alarmStatus;
-			if (k == "status") return m_deviceStatus;
-			return QString();
-			};
-		int vpos = 0;
-		while ((vpos = s.indexOf("${var:", vpos)) >= 0) {
-			int end = s.indexOf('}', vpos);
-			if (end < 0) break;
-			const QString token = s.mid(vpos, end - vpos + 1);
-			const QString key = token.mid(6, token.size() - 7);
-			s.replace(token, readVar(key));
-			vpos = vpos + 1;
+	switch (v.kind) {
+	case TemplateValue::String: {
+		QString s;
+		s.reserve(v.reserve);
+		for (const TemplateToken& t : v.tokens) {
+			switch (t.kind) {
+			case TemplateToken::Literal:
+				s += t.text;
+				break;
+			case TemplateToken::Now:
+				if (!scratch.now.isValid()) scratch.now = QDateTime::currentDateTime();
+				s += scratch.now.toString(t.text);
+				break;
+			case TemplateToken::Global:
+				if (!scratch.fetched[t.index]) {
+					scratch.globals[t.index] = UiMediator::instance()->getController()->context()->getGlobal(
+						scratch.globalKeys.at(t.index));
+					scratch.fetched[t.index] = true;
+				}
+				s += scratch.globals[t.index].toString();
+				break;
+			case TemplateToken::Msg:
+				s += scratch.msg.value(t.text).toString();
+				break;
+			case TemplateToken::Var:
+				switch (t.index) {
+				case VarDeviceId: s += m_deviceId; break;
+				case VarDeviceIp: s += m_deviceIp; break;
+				case VarProcess: s += m_process; break;
+				case VarProcessManual: s += m_process_manual; break;
+				case VarAlarmCode: s += m_alarmCode; break;
+				case VarAlarmStatus: s += m_alarmStatus; break;
+				case VarStatus: s += m_deviceStatus; break;
+				default: break;
+				}
+				break;
+			}
 		}
-
 		return s;
 	}
-	case QMetaType::QVariantMap: {
+	case TemplateValue::Map: {
 		QVariantMap out;
-		const QVariantMap inMap = in.toMap();
-		for (auto it = inMap.begin(); it != inMap.end(); ++it)
-			out.insert(it.key(), expandOneValue(it.value(), msg));
+		for (int i = 0; i < v.keys.size(); ++i)
+			out.insert(v.keys.at(i), evaluateTemplateValue(v.children.at(i), scratch));
 		return out;
 	}
-	case QMetaType::QVariantList: {
+	case TemplateValue::List: {
 		QVariantList out;
-		const QVariantList inList = in.toList();
-		for (const auto& v : inList)
-			out.push_back(expandOneValue(v, msg));
+		out.reserve(v.children.size());
+		for (const TemplateValue& c : v.children)
+			out.push_back(evaluateTemplateValue(c, scratch));
 		return out;
 	}
 	default:
-		return in;
+		return v.constant;
 	}
 }
 
@@ -1097,20 +1467,8 @@ void EapManager::handleCIMMessage(const QString& functionName, const QJsonObject
 	QString logMsg = QString("收到 CIM 消息: %1, 自动关闭时间: %2 秒").arg(message).arg(autoCloseSeconds);
 	cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, logMsg.toLocal8Bit().data());
 
-	// 创建并显示报警对话框（使用 Qt::QueuedConnection 确保在主线程执行）
-	QMetaObject::invokeMethod(this, [this, message, autoCloseSeconds]() {
-		EapAlarmDialog* dialog = new EapAlarmDialog(message, autoCloseSeconds, this);
-
-		// 连接确认信号
-		connect(dialog, &EapAlarmDialog::confirmed, this, [this, message]() {
-			QString confirmMsg = QString("CIM 消息已确认: %1").arg(message);
-			cvm::cvmLog::getInstance()->log(LOG_CATEGORY_SYSTEM, cvm::LogLevel::info, confirmMsg.toLocal8Bit().data());
-			});
-
-		// 显示对话框（模态）
-		dialog->exec();
-		dialog->deleteLater();
-		}, Qt::QueuedConnection);
+	// 交给通知中心排队显示（线程安全、立即返回），不在应答路径上等待操作员确认
+	m_notificationCenter->notify(message, autoCloseSeconds, screen_code);
 }
 
 // ============================================================================
@@ -1268,10 +1626,13 @@ void EapManager::handleCimModeChangeCommand(const QString& functionName, const Q
 
 	// 是否是在线模式
 	const QString internal_online_value = m_mapParams[FIELD_ONLINE_MODE].value(STATUS_ONLINE).toString();
-	if (cimMode == internal_online_value)
+	const QString internal_semi_auto_value = m_mapParams[FIELD_ONLINE_MODE].value(STATUS_SEMI_AUTO).toString();
+	const bool semiAuto = !internal_semi_auto_value.isEmpty() && cimMode == internal_semi_auto_value;
+	if (cimMode == internal_online_value || semiAuto)
 	{
-		// 在线模式
+		// 在线模式（半自动模式下链路同样在线，上报按接口 semiAutoEnabled 过滤）
 		QVariantMap broadcastData;
+		setCimSemiAuto(semiAuto);
 		setOnlineStatus(true);;
 		broadcastData[JSON_RESULT] = true;
 		broadcastData["topic"] = INTERFACE_ONLINE_STATUS_SET;
@@ -1284,6 +1645,7 @@ void EapManager::handleCimModeChangeCommand(const QString& functionName, const Q
 	{
 		// 离线模式
 		QVariantMap broadcastData;
+		setCimSemiAuto(false);
 		setOnlineStatus(false);;
 		broadcastData[JSON_RESULT] = false;
 		broadcastData["topic"] = INTERFACE_ONLINE_STATUS_SET;
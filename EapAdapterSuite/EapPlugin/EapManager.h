@@ -5,11 +5,20 @@
 #include <QMap>
 #include <QTimer>
 #include <QMutex>
+#include <QFileSystemWatcher>
+#include <QDateTime>
+#include <QVector>
+#include <functional>
+#include <memory>
 #include "EAPUploadQueueManager.h"
+#include "EAPDispatcher.h"
 #include "EAPWebService.h"
 #include "EapManagerConstants.h"
 #include "EAPDataCache.h"
 #include "EAPDataCacheWidget.h"
+#include "EapReportScheduler.h"
+#include "EapNotificationCenter.h"
+#include "EapAlarmAggregator.h"
 
 struct UserInfo
 {
@@ -48,21 +57,31 @@ protected:
 
 private:
     bool loadDeviceRequestParams(const QString& filename, QMap<QString, QVariantMap>& interfaceParams);
-    QVariantMap getParamsFor(const QString& interfaceName) const;
+    QVariantMap getParamsFor(const QString& interfaceName);
+    // 监视测试数据文件，文件变化时使接口参数缓存失效
+    void watchInterfaceParamsFile();
     bool loadInitialParams(const QString& filename);
 
     // 新增：加载路由配置（可选）
     bool loadRoutes(const QString& filename);
 
     // 新增：基于路由模板构造参数（支持占位符）
-    QVariantMap buildParamsFromTemplate(const QVariantMap& tmpl,
-        const QVariantMap& msg) const;
-    QVariant expandOneValue(const QVariant& in,
+    struct RouteRule;
+    struct TemplateValue;
+    struct TemplateScratch;
+    static TemplateValue compileTemplateValue(const QVariant& in, QStringList& globalKeys);
+    QVariantMap buildParamsFromTemplate(const RouteRule& rule,
         const QVariantMap& msg) const;
+    QVariant evaluateTemplateValue(const TemplateValue& v,
+        TemplateScratch& scratch) const;
 
     void setGlobal(QString name, QVariant var);
     bool setOnlineStatus(bool status);
+    // 记录 CIM 控制模式是否为半自动（与链路在线状态分开保存，重新上线时恢复）
+    void setCimSemiAuto(bool on);
     void post(const QString& interfaceKey, const QVariantMap& params);
+    // 按 CIM 模式与接口离线 / 半自动配置分发：直接发送、入队或丢弃；丢弃时不调用 build 组包
+    bool dispatch(const QString& interfaceKey, const std::function<QVariantMap()>& build, bool preferQueue = false);
     void setConnection(bool status);
     QVariantMap creatMapParams(const QString& interfaceName);
     bool isInerfaceEnabled(const QString& interfaceName);
@@ -91,12 +110,16 @@ private:
 private:
     void loadDefaultParam();
 
+    // 登记周期上报任务（心跳、时间同步）
+    void registerPeriodicReports();
+
     void handleSendUserVerifyMessage(const QVariantMap& msg);
 private slots:
     void onRequestStarted(const QString& key, const QJsonObject& json);
     void onRequestFailed(const QString& interfaceKey, const QString& errorMsg);
     void onMappedResultReady(const QString& key, const QVariantMap& result);
     void onRequestSuccess(const QString& interfaceKey, const QJsonObject& result);
+    void onAlarmTransitions(const QList<EapAlarmAggregator::Transition>& transitions);
 
 
     void handleSendMessage(const QVariantMap& message);
@@ -106,6 +129,51 @@ signals:
 
     void sigTestProcess(int step, QVariantMap result);
 private:
+    /**
+     * @brief 参数模板中字符串的一个片段
+     *
+     * 占位符: ${now:fmt} / ${global:key} / ${msg:key} / ${var:key}
+     */
+    struct TemplateToken {
+        enum Kind { Literal, Now, Global, Msg, Var };
+        Kind kind = Literal;
+        QString text;   ///< Literal：文本；Now：时间格式；Msg：消息字段名
+        int index = 0;  ///< Global：在 RouteRule::globalKeys 中的下标；Var：TemplateVar
+    };
+
+    /** @brief ${var:key} 可引用的 EapManager 成员 */
+    enum TemplateVar { VarDeviceId, VarDeviceIp, VarProcess, VarProcessManual, VarAlarmCode, VarAlarmStatus, VarStatus };
+
+    /**
+     * @brief 编译后的模板值（loadRoutes 时生成）
+     *
+     * 不含占位符的字符串与其它标量直接保存为常量；map / list 递归编译。
+     */
+    struct TemplateValue {
+        enum Kind { Constant, String, Map, List };
+        Kind kind = Constant;
+        QVariant constant;               ///< Constant：原值
+        QVector<TemplateToken> tokens;   ///< String：片段序列
+        int reserve = 0;                 ///< String：结果预估长度
+        QStringList keys;                ///< Map：键（与 children 一一对应）
+        QVector<TemplateValue> children; ///< Map / List：子值
+    };
+
+    /**
+     * @brief 单条消息展开时的临时上下文
+     *
+     * 每个被引用的全局变量在一条消息内只读取一次；当前时间也只取一次。
+     */
+    struct TemplateScratch {
+        const QVariantMap& msg;
+        const QStringList& globalKeys;
+        QVector<QVariant> globals;
+        QVector<bool> fetched;
+        QDateTime now;
+        TemplateScratch(const QVariantMap& m, const QStringList& keys)
+            : msg(m), globalKeys(keys), globals(keys.size()), fetched(keys.size(), false) {}
+    };
+
     /**
      * @brief 路由规则结构
      * 
@@ -115,7 +183,8 @@ private:
     struct RouteRule {
         QString interfaceKey;       ///< MES 接口键名
         bool useQueue = false;      ///< 是否使用队列上传（离线缓存）
-        QVariantMap paramTemplate;  ///< 参数模板（支持占位符替换）
+        TemplateValue params;       ///< 编译后的参数模板（Map，支持占位符替换）
+        QStringList globalKeys;     ///< 模板引用到的全局变量（去重）
     };
 
     /** @brief EAP 接口管理器 - 负责与 MES 系统通信 */
@@ -124,8 +193,14 @@ private:
     /** @brief 上传队列管理器 - 负责离线数据缓存和重传 */
     EAPUploadQueueManager* m_uploadQueueManager;
     
-    /** @brief 接口参数映射表 - 存储各接口的默认参数（从 infoMap.json 加载） */
+    /** @brief 接口参数映射表 - 存储各接口的默认参数（从测试数据文件加载，首次使用时读入内存） */
     QMap<QString, QVariantMap> m_interfaceParams;
+
+    /** @brief 接口参数缓存失效标志 - true: 下次使用前需从文件重新加载（初始或文件变化后） */
+    bool m_interfaceParamsDirty = true;
+
+    /** @brief 测试数据文件监视器 - 文件被修改/替换时置 m_interfaceParamsDirty */
+    QFileSystemWatcher m_paramsFileWatcher;
     
     /** @brief 通用参数映射表 - 存储参数映射规则（从 infoMap.json 加载） */
     QMap<QString, QVariantMap> m_mapParams;
@@ -135,6 +210,9 @@ private:
 
     /** @brief 在线状态标志 - true: 在线模式，false: 离线模式 */
     bool m_isOnline = false;
+
+    /** @brief CIM 控制模式为半自动 - 由 MES 模式切换命令设置；链路断开再上线时据此恢复 Semi-Auto 分发 */
+    bool m_cimSemiAuto = false;
     
     /** @brief 设备 ID - 设备的唯一标识符（从 eap.ini 加载） */
     QString m_deviceId;
@@ -178,6 +256,18 @@ private:
     
     /** @brief 时间同步间隔 - 时间同步间隔（毫秒），默认 3600000ms（1小时） */
     int m_synTimeTime = 3600000;
+
+    /** @brief 周期上报抖动幅度 - 每个周期随机偏移 ±百分比，默认 10 */
+    int m_reportJitterPercent = 10;
+
+    /** @brief CIM 对话框上限 - 告警风暴时同时打开的 CIM 对话框数量上限，默认 3 */
+    int m_maxCimDialogs = 3;
+
+    /** @brief 告警防抖时间 - 告警状态变化保持该时间（毫秒）才上报，默认 200ms */
+    int m_alarmDebounceMs = 200;
+
+    /** @brief 告警合并上限 - 单次合并上报的告警条数上限，默认 50 */
+    int m_alarmBatchMax = 50;
     
     /** @brief 访问令牌 - 用于 MES 接口认证的 token */
     QString m_token;
@@ -185,11 +275,17 @@ private:
     /** @brief 离线缓存开关 - true: 离线时缓存数据，false: 离线时丢弃数据 */
     bool m_isCacheData = false;
 
-    /** @brief 心跳定时器 - 定期向 MES 发送心跳 */
-    QTimer m_heartBeatTimer;
-    
-    /** @brief 时间同步定时器 - 定期与 MES 同步时间 */
-    QTimer m_synTimeTimer;
+    /** @brief 上报分发策略 - 按 CIM 模式与接口 offlineEnabled / offlineCache / semiAutoEnabled 决定发送、入队或丢弃 */
+    std::unique_ptr<EAPDispatcher> m_dispatcher;
+
+    /** @brief 周期上报调度器 - 心跳、时间同步等定期上报（按接口键名登记） */
+    EapReportScheduler* m_reportScheduler = nullptr;
+
+    /** @brief CIM 消息通知中心 - 排队、合并 CIM 消息并限制同时打开的对话框数量 */
+    EapNotificationCenter* m_notificationCenter = nullptr;
+
+    /** @brief 告警聚合器 - 维护告警状态表，防抖、去重后按批上报 */
+    EapAlarmAggregator* m_alarmAggregator = nullptr;
 
     /** @brief 当前告警代码 - 最新发生的告警代码 */
     QString m_alarmCode;
@@ -210,7 +306,7 @@ private:
     /** @brief 状态互斥锁 - 保护状态变量（m_isOnline, m_deviceStatus 等） */
     mutable QMutex m_stateMutex;
     
-    /** @brief 参数互斥锁 - 保护参数映射（m_interfaceParams, m_mapParams） */
+    /** @brief 参数互斥锁 - 保护参数映射（m_interfaceParams, m_interfaceParamsDirty, m_mapParams） */
     mutable QMutex m_paramsMutex;
 
 	//用户信息
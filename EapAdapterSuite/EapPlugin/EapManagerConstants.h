@@ -141,6 +141,9 @@ namespace EapConstants {
     
     /** @brief 告警文本字段 */
     constexpr const char* FIELD_ALARM_TEXT = "alarm_text";
+
+    /** @brief 告警列表字段（接口 body 映射中配置此键时，多条告警合并为一次上报） */
+    constexpr const char* FIELD_ALARM_LIST = "alarm_list";
     
     /** @brief 用户名字段 */
     constexpr const char* FIELD_USER_NAME = "user_name";
@@ -279,6 +282,9 @@ namespace EapConstants {
     
     /** @brief 离线状态 */
     constexpr const char* STATUS_OFFLINE = "offline";
+
+    /** @brief 半自动状态（infoMap.json 中 online_mode 的 semi_auto 映射） */
+    constexpr const char* STATUS_SEMI_AUTO = "semi_auto";
     
     /** @brief 告警发生状态 */
     constexpr const char* STATUS_OCCURRENCE = "occurrence";
@@ -341,9 +347,24 @@ namespace EapConstants {
     
     /** @brief INI 配置项：时间同步间隔 */
     constexpr const char* INI_KEY_SYN_TIME_TIME = "synTimeTime";
+
+    /** @brief INI 配置项：周期上报抖动幅度（周期的百分比，0 表示不抖动） */
+    constexpr const char* INI_KEY_REPORT_JITTER_PERCENT = "reportJitterPercent";
+
+    /** @brief INI 配置项：CIM 消息同时打开的对话框上限 */
+    constexpr const char* INI_KEY_MAX_CIM_DIALOGS = "maxCimDialogs";
+
+    /** @brief INI 配置项：告警状态变化的防抖时间（毫秒） */
+    constexpr const char* INI_KEY_ALARM_DEBOUNCE_MS = "alarmDebounceMs";
+
+    /** @brief INI 配置项：单次合并上报的告警条数上限 */
+    constexpr const char* INI_KEY_ALARM_BATCH_MAX = "alarmBatchMax";
     
     /** @brief INI 配置项：离线缓存开关 */
     constexpr const char* INI_KEY_OFFLINE_CACHE = "offlineCache";
+
+    /** @brief INI 配置项：MES 通讯日志级别（debug / info / error），低于该级别的日志不写入也不组装 */
+    constexpr const char* INI_KEY_MES_LOG_LEVEL = "mesLogLevel";
     
     /** @brief INI 配置项：令牌 */
     constexpr const char* INI_KEY_TOKEN = "token";
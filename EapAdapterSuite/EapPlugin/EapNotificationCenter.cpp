@@ -0,0 +1,123 @@
+﻿#include "EapNotificationCenter.h"
+#include "EapAlarmDialog.h"
+
+#include <QWidget>
+
+EapNotificationCenter::EapNotificationCenter(QWidget* dialogParent, QObject* parent)
+    : QObject(parent)
+    , dialogParent_(dialogParent)
+{
+}
+
+EapNotificationCenter::~EapNotificationCenter()
+{
+    // 对话框挂在 dialogParent_ 下，通知中心先析构时断开回调，避免访问已释放的 entries_
+    for (const Entry& e : entries_) {
+        if (e.dialog)
+            e.dialog->disconnect(this);
+    }
+}
+
+QString EapNotificationCenter::keyOf(const QString& message, const QString& code)
+{
+    return code + QChar(0x1F) + message;
+}
+
+void EapNotificationCenter::notify(const QString& message, int autoCloseSeconds, const QString& code)
+{
+    const QString key = keyOf(message, code);
+    // 无论调用线程，统一排队到通知中心所在线程处理，调用方不等待界面
+    QMetaObject::invokeMethod(this, [this, key, message, autoCloseSeconds]() {
+        enqueue(key, message, autoCloseSeconds);
+        }, Qt::QueuedConnection);
+}
+
+void EapNotificationCenter::setMaxOpenDialogs(int count)
+{
+    maxOpenDialogs_ = qMax(1, count);
+    showPending();
+}
+
+void EapNotificationCenter::setMaxPending(int count)
+{
+    maxPending_ = qMax(1, count);
+}
+
+void EapNotificationCenter::enqueue(const QString& key, const QString& message, int autoCloseSeconds)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        // 相同消息：合并计数，沿用最新的自动关闭时间
+        ++it->count;
+        it->autoCloseSeconds = autoCloseSeconds;
+        it->lastTime = now;
+        ++coalescedCount_;
+        if (it->dialog) {
+            it->dialog->setRepeatCount(it->count);
+            it->dialog->setAutoCloseTime(autoCloseSeconds); // 重新开始倒计时
+            it->dialog->raise();
+        }
+        return;
+    }
+
+    Entry e;
+    e.message = message;
+    e.autoCloseSeconds = autoCloseSeconds;
+    e.count = 1;
+    e.firstTime = now;
+    e.lastTime = now;
+    entries_.insert(key, e);
+
+    if (openCount_ < maxOpenDialogs_) {
+        open(key);
+        return;
+    }
+
+    pending_.enqueue(key);
+    while (pending_.size() > maxPending_) {
+        const QString oldest = pending_.dequeue();
+        const Entry old = entries_.take(oldest);
+        droppedCount_ += old.count;
+        emit dropped(old.message, old.count);
+    }
+}
+
+void EapNotificationCenter::open(const QString& key)
+{
+    auto it = entries_.find(key);
+    if (it == entries_.end())
+        return;
+
+    EapAlarmDialog* dialog = new EapAlarmDialog(it->message, it->autoCloseSeconds, dialogParent_);
+    // 多个对话框可同时存在，改为非模态，操作员可按任意顺序确认
+    dialog->setModal(false);
+    if (it->count > 1)
+        dialog->setRepeatCount(it->count);
+
+    connect(dialog, &QDialog::finished, this, [this, key]() { onDialogFinished(key); });
+
+    it->dialog = dialog;
+    ++openCount_;
+    dialog->show();
+    dialog->raise();
+    dialog->activateWindow();
+}
+
+void EapNotificationCenter::onDialogFinished(const QString& key)
+{
+    const Entry e = entries_.take(key);
+    if (e.dialog) {
+        e.dialog->deleteLater();
+        --openCount_;
+    }
+    emit confirmed(e.message, e.count);
+    showPending();
+}
+
+void EapNotificationCenter::showPending()
+{
+    while (openCount_ < maxOpenDialogs_ && !pending_.isEmpty())
+        open(pending_.dequeue());
+}
@@ -0,0 +1,95 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QQueue>
+#include <QDateTime>
+
+class QWidget;
+class EapAlarmDialog;
+
+/**
+ * @brief CIM 消息通知中心
+ *
+ * MES 下发的 CIM 消息不在应答路径上弹模态框，而是交给通知中心排队，应答立即返回：
+ * - notify() 可在任意线程调用，消息经队列投递到通知中心所在线程（GUI 线程）再显示；
+ * - 相同的消息（屏幕代码 + 文本）合并为一个对话框并显示重复次数，已打开的对话框重新开始倒计时；
+ * - 同时打开的对话框数量有上限，超出的消息排队，对话框关闭后依次弹出；
+ * - 排队消息超过上限时丢弃最早的一条，并通过 dropped() 通知。
+ *
+ * 除 notify() 外的接口需在通知中心所属线程调用。
+ */
+class EapNotificationCenter : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @param dialogParent 对话框的父窗口（用于居中显示，可为空）
+     * @param parent       QObject 父对象
+     */
+    explicit EapNotificationCenter(QWidget* dialogParent, QObject* parent = nullptr);
+    ~EapNotificationCenter() override;
+
+    /**
+     * @brief 投递一条 CIM 消息（线程安全，立即返回）
+     * @param message          消息文本
+     * @param autoCloseSeconds 自动关闭秒数（0 表示需要手动确认）
+     * @param code             屏幕代码，参与相同消息的判定
+     */
+    void notify(const QString& message, int autoCloseSeconds, const QString& code = QString());
+
+    /** @brief 同时打开的对话框上限（>= 1，默认 3） */
+    void setMaxOpenDialogs(int count);
+    int maxOpenDialogs() const { return maxOpenDialogs_; }
+
+    /** @brief 排队消息上限（>= 1，默认 100） */
+    void setMaxPending(int count);
+
+    int openCount() const { return openCount_; }
+    int pendingCount() const { return pending_.size(); }
+    /** @brief 累计被合并（未单独弹框）的消息条数 */
+    int coalescedCount() const { return coalescedCount_; }
+    /** @brief 累计因排队溢出被丢弃的消息条数 */
+    int droppedCount() const { return droppedCount_; }
+
+signals:
+    /**
+     * @brief 对话框已确认（手动或自动）
+     * @param message 消息文本
+     * @param count   该对话框合并的消息条数
+     */
+    void confirmed(const QString& message, int count);
+
+    /**
+     * @brief 排队溢出，最早的一条排队消息被丢弃
+     * @param message 消息文本
+     * @param count   该条合并的消息条数
+     */
+    void dropped(const QString& message, int count);
+
+private:
+    struct Entry {
+        QString message;
+        int autoCloseSeconds = 0;
+        int count = 0;                    ///< 合并的消息条数
+        QDateTime firstTime;              ///< 首次收到时间
+        QDateTime lastTime;               ///< 最近一次收到时间
+        EapAlarmDialog* dialog = nullptr; ///< 已打开的对话框（排队中为空）
+    };
+
+    static QString keyOf(const QString& message, const QString& code);
+    void enqueue(const QString& key, const QString& message, int autoCloseSeconds);
+    void open(const QString& key);
+    void onDialogFinished(const QString& key);
+    void showPending();
+
+    QWidget* dialogParent_ = nullptr;
+    QHash<QString, Entry> entries_;   ///< 已打开或排队中的消息（按 key 合并）
+    QQueue<QString> pending_;         ///< 排队中的 key（先进先出）
+    int openCount_ = 0;
+    int maxOpenDialogs_ = 3;
+    int maxPending_ = 100;
+    int coalescedCount_ = 0;
+    int droppedCount_ = 0;
+};
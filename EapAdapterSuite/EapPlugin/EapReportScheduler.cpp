@@ -0,0 +1,159 @@
+﻿#include "EapReportScheduler.h"
+
+#include <QTimer>
+#include <QRandomGenerator>
+
+EapReportScheduler::EapReportScheduler(QObject* parent)
+    : QObject(parent)
+{
+}
+
+EapReportScheduler::~EapReportScheduler()
+{
+    stopAll();
+}
+
+void EapReportScheduler::registerJob(const QString& id, int intervalMs, Task task, int jitterPercent)
+{
+    Job& job = jobs_[id];
+    job.info.id = id;
+    job.info.intervalMs = intervalMs;
+    job.info.jitterPercent = qBound(0, jitterPercent, 50);
+    job.task = std::move(task);
+
+    if (!job.timer) {
+        job.timer = new QTimer(this);
+        job.timer->setSingleShot(true);
+        // 每个任务只连接一次；替换任务只更新回调
+        connect(job.timer, &QTimer::timeout, this, [this, id]() { fire(id); });
+    }
+
+    if (job.info.active)
+        schedule(job);
+}
+
+void EapReportScheduler::unregisterJob(const QString& id)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end())
+        return;
+    if (it->timer) {
+        it->timer->stop();
+        it->timer->deleteLater();
+    }
+    jobs_.erase(it);
+}
+
+void EapReportScheduler::start(const QString& id, bool fireNow)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end())
+        return;
+
+    it->info.active = true;
+    if (fireNow) {
+        fire(id); // fire 内部会重新排期
+        return;
+    }
+    schedule(*it);
+}
+
+void EapReportScheduler::stop(const QString& id)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end())
+        return;
+    it->info.active = false;
+    it->info.nextFire = QDateTime();
+    if (it->timer)
+        it->timer->stop();
+}
+
+void EapReportScheduler::stopAll()
+{
+    for (auto it = jobs_.begin(); it != jobs_.end(); ++it) {
+        it->info.active = false;
+        it->info.nextFire = QDateTime();
+        if (it->timer)
+            it->timer->stop();
+    }
+}
+
+bool EapReportScheduler::isRegistered(const QString& id) const
+{
+    return jobs_.contains(id);
+}
+
+bool EapReportScheduler::isActive(const QString& id) const
+{
+    const auto it = jobs_.constFind(id);
+    return it != jobs_.constEnd() && it->info.active;
+}
+
+void EapReportScheduler::reportResult(const QString& id, bool ok, const QString& detail)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end())
+        return;
+    it->info.lastOk = ok;
+    it->info.lastResult = detail;
+    it->info.lastResultTime = QDateTime::currentDateTime();
+}
+
+EapReportScheduler::JobInfo EapReportScheduler::jobInfo(const QString& id) const
+{
+    const auto it = jobs_.constFind(id);
+    return it != jobs_.constEnd() ? it->info : JobInfo();
+}
+
+QList<EapReportScheduler::JobInfo> EapReportScheduler::jobs() const
+{
+    QList<JobInfo> out;
+    out.reserve(jobs_.size());
+    for (auto it = jobs_.constBegin(); it != jobs_.constEnd(); ++it)
+        out.append(it->info);
+    return out;
+}
+
+/**
+ * @brief 计算下一个周期的等待时间：基准周期 ± jitterPercent% 内均匀随机
+ */
+int EapReportScheduler::nextDelay(const JobInfo& info) const
+{
+    if (info.jitterPercent <= 0)
+        return info.intervalMs;
+    const int span = int(qint64(info.intervalMs) * info.jitterPercent / 100);
+    if (span <= 0)
+        return info.intervalMs;
+    const int offset = QRandomGenerator::global()->bounded(-span, span + 1);
+    return qMax(1, info.intervalMs + offset);
+}
+
+void EapReportScheduler::schedule(Job& job)
+{
+    if (!job.info.active || job.info.intervalMs <= 0 || !job.timer) {
+        job.info.nextFire = QDateTime();
+        return;
+    }
+    const int delay = nextDelay(job.info);
+    job.info.nextFire = QDateTime::currentDateTime().addMSecs(delay);
+    job.timer->start(delay);
+}
+
+void EapReportScheduler::fire(const QString& id)
+{
+    auto it = jobs_.find(id);
+    if (it == jobs_.end() || !it->info.active)
+        return;
+
+    it->info.lastFire = QDateTime::currentDateTime();
+    ++it->info.fireCount;
+
+    // 先排下一期：回调中可能 stop / 重新登记本任务
+    schedule(*it);
+
+    const Task task = it->task; // 回调中可能修改 jobs_，这里持有副本
+    if (task)
+        task();
+    emit jobFired(id);
+}
@@ -0,0 +1,101 @@
+﻿#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <functional>
+
+class QTimer;
+
+/**
+ * @brief 周期上报调度器
+ *
+ * 统一管理发往 MES 的周期性上报（心跳、时间同步、稼动率等）：
+ * - 任务按 id 登记，重复登记只替换原任务，不会出现同一任务多次触发；
+ * - 每个周期可加入随机抖动（±jitterPercent%），避免大量设备同相位上报；
+ * - 记录每个任务的下次触发时间与最近一次结果，便于诊断。
+ *
+ * 所有接口需在调度器所属线程（通常为 GUI 线程）调用。
+ */
+class EapReportScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief 任务状态快照
+     */
+    struct JobInfo {
+        QString id;
+        int intervalMs = 0;          ///< 基准周期
+        int jitterPercent = 0;       ///< 抖动幅度（周期的百分比）
+        bool active = false;         ///< 是否在调度中
+        QDateTime nextFire;          ///< 下次触发时间（未调度时无效）
+        QDateTime lastFire;          ///< 最近一次触发时间
+        QDateTime lastResultTime;    ///< 最近一次结果时间
+        bool lastOk = false;         ///< 最近一次结果是否成功
+        QString lastResult;          ///< 最近一次结果说明
+        int fireCount = 0;           ///< 累计触发次数
+    };
+
+    explicit EapReportScheduler(QObject* parent = nullptr);
+    ~EapReportScheduler() override;
+
+    /**
+     * @brief 登记（或替换）周期任务
+     * @param id            任务 id（通常用接口键名），同 id 只保留一个
+     * @param intervalMs    基准周期（毫秒），<= 0 时任务不会被调度
+     * @param task          触发时执行的回调
+     * @param jitterPercent 每个周期的随机抖动幅度（0~50）
+     *
+     * 任务已在调度中时保持调度状态，并按新周期重新排期。
+     */
+    void registerJob(const QString& id, int intervalMs, Task task, int jitterPercent = 0);
+
+    /** @brief 注销任务 */
+    void unregisterJob(const QString& id);
+
+    /**
+     * @brief 开始调度
+     * @param id      任务 id
+     * @param fireNow true 时立即执行一次再开始计时
+     *
+     * 已在调度中时重新排期（不会叠加）。
+     */
+    void start(const QString& id, bool fireNow = false);
+
+    /** @brief 停止调度（保留登记） */
+    void stop(const QString& id);
+    void stopAll();
+
+    bool isRegistered(const QString& id) const;
+    bool isActive(const QString& id) const;
+
+    /**
+     * @brief 记录任务最近一次结果（由上报的成功/失败回调调用；未登记的 id 忽略）
+     */
+    void reportResult(const QString& id, bool ok, const QString& detail = QString());
+
+    JobInfo jobInfo(const QString& id) const;
+    QList<JobInfo> jobs() const;
+
+signals:
+    /** @brief 任务被触发 */
+    void jobFired(const QString& id);
+
+private:
+    struct Job {
+        JobInfo info;
+        Task task;
+        QTimer* timer = nullptr;
+    };
+
+    void schedule(Job& job);
+    void fire(const QString& id);
+    int nextDelay(const JobInfo& info) const;
+
+    QHash<QString, Job> jobs_;
+};
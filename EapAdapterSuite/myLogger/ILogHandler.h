@@ -13,6 +13,12 @@ namespace myLog
         ~ILogHandler() override;
 
         virtual void log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite) = 0;
+        // handlers without an async backend ignore async_config
+        virtual void log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite,
+                              const logAsyncConfig& async_config)
+        {
+            log_init(dir, max_size, max_file, overwrite);
+        }
 
         virtual void log_write(logType log_type, const std::string& smg, const std::string& msg_withfileinfo,
                                logLevel level) = 0;
@@ -20,6 +26,10 @@ namespace myLog
                                logLevel level) = 0;
         virtual void log_flush() = 0;
 
+        virtual bool should_log(const std::string& log_type, logLevel level) { return true; }
+        // minimum level written for log_type; also applies to a type registered later
+        virtual void set_level(const std::string& log_type, logLevel level) {}
+
         virtual bool contains(logType type) = 0;
         virtual bool contains(const std::string& type) = 0;
         virtual int regist_log(logType type, logConfig l_config) = 0;
@@ -18,6 +18,10 @@
 #define LOG_TYPE_INFO(type,...) myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->mylog_write(type,myLog::logLevel::lv_info,fmt::format(__VA_ARGS__),fmt::format("[{}] - [{}:{} ]", fmt::format(__VA_ARGS__),__FILE__,__LINE__))
 #define LOG_TYPE_ERROR(type,...)  myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->mylog_write(type,myLog::logLevel::lv_error,fmt::format(__VA_ARGS__),fmt::format("[{}] - [{}:{} ]", fmt::format(__VA_ARGS__),__FILE__,__LINE__))
 
+#define LOG_TYPE_SHOULD_LOG(type,level) myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->should_log(type,level)
+#define LOG_TYPE_DEBUG_ENABLED(type) LOG_TYPE_SHOULD_LOG(type,myLog::logLevel::lv_debug)
+#define LOG_TYPE_SET_LEVEL(type,level) myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->set_level(type,level)
+
 #define LOG_TYPE_DEBUG_WITHOUT_FILEINFO(type,...)  myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->mylog_write(type,myLog::logLevel::lv_debug,fmt::format(__VA_ARGS__),fmt::format("[{}]", fmt::format(__VA_ARGS__)))
 #define LOG_TYPE_INFO_WITHOUT_FILEINFO(type,...) myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->mylog_write(type,myLog::logLevel::lv_info,fmt::format(__VA_ARGS__),fmt::format("[{}]", fmt::format(__VA_ARGS__)))
 #define LOG_TYPE_ERROR_WITHOUT_FILEINFO(type,...)  myLog::myLogger::get_instance(myLog::log_source_type::log_spd)->mylog_write(type,myLog::logLevel::lv_error,fmt::format(__VA_ARGS__),fmt::format("[{}]", fmt::format(__VA_ARGS__)))
@@ -13,7 +13,28 @@ SpdLogHandler::SpdLogHandler(QObject* parent)
 
 SpdLogHandler::~SpdLogHandler()
 {
-    spdlog::shutdown();
+    // drain: stop our flusher, flush our loggers, drop only the registrations that are ours,
+    // then join the backend threads. loggers registered by other code are left alone
+    flusher.reset();
+    const auto release = [](auto& loggers)
+    {
+        for (auto& item : loggers)
+        {
+            item.second->flush();
+            if (spdlog::get(item.second->name()) == item.second)
+            {
+                spdlog::drop(item.second->name());
+            }
+        }
+        loggers.clear();
+    };
+    release(logger_map);
+    release(logger_map2);
+    {
+        std::lock_guard<std::mutex> lock(async_loggers_mutex);
+        async_loggers.clear();
+    }
+    thread_pool.reset();
 }
 
 void SpdLogHandler::log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite)
@@ -40,17 +61,164 @@ void SpdLogHandler::log_init(const std::string& dir, size_t max_size, int max_fi
     const std::string operation_filename = "logs/" + get_folder_name() + "/operation_" + std::string(date_buf) + ".log";
     template_filename = "logs/" + get_folder_name() + "/TEMPLATE_" + std::string(date_buf) + ".log";
 
-    PTR run_logger;
-    CREATE_SPDLOG_FILE_LOGGER("running_log", run_filename, log_maxsize, log_maxfile, run_logger);
-    logger_map.insert(std::make_pair(logType::logtype_running, std::move(run_logger)));
-
-    PTR operation_logger;
-    CREATE_SPDLOG_FILE_LOGGER("operation_log", operation_filename, log_maxsize, log_maxfile, operation_logger);
-    logger_map.insert(std::make_pair(logType::logtype_operation, std::move(operation_logger)));
+    logger_map.insert(std::make_pair(logType::logtype_running, create_logger("running_log", run_filename)));
+    logger_map.insert(std::make_pair(logType::logtype_operation, create_logger("operation_log", operation_filename)));
 
     m_Init = true;
 }
 
+void SpdLogHandler::log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite,
+                             const logAsyncConfig& async_config)
+{
+    log_init(dir, max_size, max_file, overwrite);
+    apply_async_config(async_config);
+}
+
+void SpdLogHandler::apply_async_config(const logAsyncConfig& async_config)
+{
+    if (!async_config.enabled && !async_cfg.enabled)
+    {
+        return;
+    }
+
+    flusher.reset();
+    {
+        std::lock_guard<std::mutex> lock(async_loggers_mutex);
+        async_loggers.clear(); // make_logger re-adds the rebuilt async loggers
+    }
+
+    auto old_pool = thread_pool;
+    async_cfg = async_config;
+    async_cfg.queue_size = std::max<size_t>(async_cfg.queue_size, 1);
+    async_cfg.thread_count = std::max<size_t>(async_cfg.thread_count, 1);
+    if (async_cfg.enabled)
+    {
+        thread_pool = std::make_shared<spdlog::details::thread_pool>(async_cfg.queue_size, async_cfg.thread_count);
+    }
+    else
+    {
+        thread_pool.reset();
+    }
+
+    // rebuild the existing loggers around their sinks; the old loggers flush what they still hold.
+    // a logger shared by several types is rebuilt once; only our own registration is dropped
+    std::map<PTR, PTR> rebuilt;
+    const auto rebuild = [this, &rebuilt](auto& loggers)
+    {
+        for (auto& item : loggers)
+        {
+            const PTR old_logger = item.second;
+            const auto done = rebuilt.find(old_logger);
+            if (done != rebuilt.end())
+            {
+                item.second = done->second;
+                continue;
+            }
+            old_logger->flush();
+            if (spdlog::get(old_logger->name()) == old_logger)
+            {
+                spdlog::drop(old_logger->name());
+            }
+            item.second = make_logger(old_logger->name(), old_logger->sinks());
+            item.second->set_level(old_logger->level());
+            rebuilt.emplace(old_logger, item.second);
+        }
+    };
+    rebuild(logger_map);
+    rebuild(logger_map2);
+    old_pool.reset(); // the old backend threads drain their queue before joining
+
+    if (async_cfg.enabled && async_cfg.flush_interval_ms > 0)
+    {
+        flusher = std::make_unique<spdlog::details::periodic_worker>([this]() { flush_async_loggers(); },
+                                                                     std::chrono::milliseconds(async_cfg.flush_interval_ms));
+    }
+}
+
+PTR SpdLogHandler::create_logger(const std::string& logger_name, const std::string& filename)
+{
+    // a name we already own is reused (same logger, same file) instead of opening a second sink
+    if (PTR existing = find_logger(logger_name))
+    {
+        return existing;
+    }
+    spdlog::sink_ptr file_sink;
+    CREATE_SPDLOG_FILE_HANDLER(filename, file_sink, log_maxsize, log_maxfile);
+    return make_logger(logger_name, {file_sink});
+}
+
+PTR SpdLogHandler::make_logger(const std::string& logger_name, const std::vector<spdlog::sink_ptr>& sinks)
+{
+    PTR logger;
+    if (async_cfg.enabled)
+    {
+        const auto policy = async_cfg.overflow == logOverflowPolicy::overrun_oldest
+                                ? spdlog::async_overflow_policy::overrun_oldest
+                                : spdlog::async_overflow_policy::block;
+        logger = std::make_shared<spdlog::async_logger>(logger_name, sinks.begin(), sinks.end(), thread_pool, policy);
+        logger->set_level(spdlog::level::trace);
+        logger->flush_on(spdlog::level::err);
+        {
+            std::lock_guard<std::mutex> lock(async_loggers_mutex);
+            async_loggers.push_back(logger);
+        }
+        // registered so spdlog::get finds it; a name registered elsewhere is never evicted.
+        // the periodic flush does not depend on the registration
+        try
+        {
+            spdlog::register_logger(logger);
+        }
+        catch (const spdlog::spdlog_ex& ex)
+        {
+            logger->warn("logger name '{}' is already registered elsewhere, not registering: {}", logger_name,
+                         ex.what());
+        }
+    }
+    else
+    {
+        logger = std::make_shared<spdlog::logger>(logger_name, sinks.begin(), sinks.end());
+        logger->set_level(spdlog::level::trace);
+        logger->flush_on(spdlog::level::info);
+    }
+    return logger;
+}
+
+PTR SpdLogHandler::find_logger(const std::string& logger_name) const
+{
+    for (const auto& item : logger_map)
+    {
+        if (item.second->name() == logger_name)
+        {
+            return item.second;
+        }
+    }
+    for (const auto& item : logger_map2)
+    {
+        if (item.second->name() == logger_name)
+        {
+            return item.second;
+        }
+    }
+    return nullptr;
+}
+
+void SpdLogHandler::flush_async_loggers()
+{
+    std::lock_guard<std::mutex> lock(async_loggers_mutex);
+    for (const auto& logger : async_loggers)
+    {
+        logger->flush();
+    }
+}
+
+void SpdLogHandler::flush_if_sync(const PTR& logger) const
+{
+    if (!async_cfg.enabled)
+    {
+        logger->flush();
+    }
+}
+
 void SpdLogHandler::log_write(logType log_type, const std::string& msg, const std::string& msg_withfileinfo,
                               logLevel level)
 {
@@ -65,21 +233,19 @@ void SpdLogHandler::log_write(logType log_type, const std::string& msg, const st
     case logLevel::lv_debug:
         {
             spd_logger->debug(msg_withfileinfo);
-
-            spd_logger->flush();
+            flush_if_sync(spd_logger);
         }
         break;
     case logLevel::lv_info:
         {
             spd_logger->info(msg_withfileinfo);
-
-            spd_logger->flush();
+            flush_if_sync(spd_logger);
         }
         break;
     case logLevel::lv_error:
         {
             spd_logger->error(msg_withfileinfo);
-            spd_logger->flush();
+            flush_if_sync(spd_logger); // async loggers flush_on(err)
         }
         break;
     }
@@ -99,21 +265,19 @@ void SpdLogHandler::log_write(const std::string& log_type, const std::string& sm
     case logLevel::lv_debug:
         {
             spd_logger->debug(msg_withfileinfo);
-
-            spd_logger->flush();
+            flush_if_sync(spd_logger);
         }
         break;
     case logLevel::lv_info:
         {
             spd_logger->info(msg_withfileinfo);
-
-            spd_logger->flush();
+            flush_if_sync(spd_logger);
         }
         break;
     case logLevel::lv_error:
         {
             spd_logger->error(msg_withfileinfo);
-            spd_logger->flush();
+            flush_if_sync(spd_logger); // async loggers flush_on(err)
         }
         break;
     }
@@ -123,6 +287,26 @@ void SpdLogHandler::log_flush()
 {
 }
 
+bool SpdLogHandler::should_log(const std::string& log_type, logLevel level)
+{
+    const auto spd_logger = get_logger(log_type);
+    if (!spd_logger)
+    {
+        return true;
+    }
+    return spd_logger->should_log(to_spd_level(level));
+}
+
+void SpdLogHandler::set_level(const std::string& log_type, logLevel level)
+{
+    configured_levels[log_type] = level;
+    const auto spd_logger = get_logger(log_type);
+    if (spd_logger)
+    {
+        spd_logger->set_level(to_spd_level(level));
+    }
+}
+
 bool SpdLogHandler::contains(logType type)
 {
     return logger_map.contains(type);
@@ -139,10 +323,9 @@ int SpdLogHandler::regist_log(logType type, logConfig l_config)
     {
         return 0;
     }
-    PTR logger;
     QString str = QString::fromStdString(template_filename);
     const std::string filename = str.replace("TEMPLATE", l_config.log_filename.c_str()).toStdString();
-    CREATE_SPDLOG_FILE_LOGGER(l_config.log_name, filename, log_maxsize, log_maxfile, logger);
+    PTR logger = create_logger(l_config.log_name, filename);
     logger_map.insert(std::make_pair(type, std::move(logger)));
     return 0;
 }
@@ -153,10 +336,14 @@ int SpdLogHandler::regist_log(const std::string& type, logConfig l_config)
     {
         return 0;
     }
-    PTR logger;
     QString str = QString::fromStdString(template_filename);
     const std::string filename = str.replace("TEMPLATE", l_config.log_filename.c_str()).toStdString();
-    CREATE_SPDLOG_FILE_LOGGER(l_config.log_name, filename, log_maxsize, log_maxfile, logger);
+    PTR logger = create_logger(l_config.log_name, filename);
+    const auto level = configured_levels.find(type);
+    if (level != configured_levels.end())
+    {
+        logger->set_level(to_spd_level(level->second));
+    }
     logger_map2.insert(std::make_pair(type, std::move(logger)));
     return 0;
 }
@@ -182,6 +369,26 @@ std::string SpdLogHandler::get_folder_name()
     return oss.str();
 }
 
+spdlog::level::level_enum SpdLogHandler::to_spd_level(logLevel level)
+{
+    switch (level)
+    {
+    case logLevel::lv_trace:
+        return spdlog::level::trace;
+    case logLevel::lv_debug:
+        return spdlog::level::debug;
+    case logLevel::lv_info:
+        return spdlog::level::info;
+    case logLevel::lv_warn:
+        return spdlog::level::warn;
+    case logLevel::lv_error:
+        return spdlog::level::err;
+    case logLevel::lv_critical:
+        return spdlog::level::critical;
+    }
+    return spdlog::level::info;
+}
+
 std::shared_ptr<spdlog::logger> SpdLogHandler::get_logger(logType logtype)
 {
     if (contains(logtype))
@@ -1,7 +1,11 @@
 #pragma once
 #include "implement.h"
 #include "ILogHandler.h"
+#include <spdlog/details/periodic_worker.h>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace myLog
 {
@@ -13,11 +17,17 @@ namespace myLog
         explicit SpdLogHandler(QObject* parent = nullptr);
         ~SpdLogHandler() override;
         void log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite) override;
+        // async_config.enabled switches every logger to spdlog's thread pool: no per-line flush,
+        // a periodic flush of our own loggers, flush on error; the destructor drains the queue
+        void log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite,
+                      const logAsyncConfig& async_config) override;
         void log_write(logType log_type, const std::string& smg, const std::string& msg_withfileinfo,
                        logLevel level) override;
         void log_write(const std::string& log_type, const std::string& smg, const std::string& msg_withfileinfo,
                        logLevel level) override;
         void log_flush() override;
+        bool should_log(const std::string& log_type, logLevel level) override;
+        void set_level(const std::string& log_type, logLevel level) override;
         bool contains(logType type) override;
         bool contains(const std::string& type) override;
         int regist_log(logType type, logConfig l_config) override;
@@ -28,6 +38,15 @@ namespace myLog
         void message_distribution(logLevel level, const std::string& type, const std::string& msg);
     private:
         static std::string get_folder_name();
+        static spdlog::level::level_enum to_spd_level(logLevel level);
+
+    private:
+        PTR create_logger(const std::string& logger_name, const std::string& filename);
+        PTR make_logger(const std::string& logger_name, const std::vector<spdlog::sink_ptr>& sinks);
+        PTR find_logger(const std::string& logger_name) const;
+        void apply_async_config(const logAsyncConfig& async_config);
+        void flush_if_sync(const PTR& logger) const;
+        void flush_async_loggers();
 
     private:
         std::shared_ptr<spdlog::logger> get_logger(logType logtype);
@@ -41,5 +60,15 @@ namespace myLog
         bool m_Init = false;
 
         std::string template_filename;
+
+        std::map<std::string, logLevel> configured_levels; // set_level before / after regist_log
+
+        logAsyncConfig async_cfg;
+        std::shared_ptr<spdlog::details::thread_pool> thread_pool;
+        // async loggers made by this handler, flushed every flush_interval_ms by our own worker
+        // (not spdlog::flush_every, which only reaches registered loggers and is process-wide)
+        std::mutex async_loggers_mutex;
+        std::vector<PTR> async_loggers;
+        std::unique_ptr<spdlog::details::periodic_worker> flusher;
     };
 }
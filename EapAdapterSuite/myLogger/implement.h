@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/async.h>
 
 #define CREATE_QUILL_FILE_HANDLER(filename, handler,max_size,backup_file,overwrite) \
     handler = quill::file_handler(filename, \
@@ -56,6 +56,22 @@ namespace myLog
         logtype_totalcount = 1000
     };
 
+    enum class logOverflowPolicy
+    {
+        block,          // caller waits for a free queue slot
+        overrun_oldest  // oldest queued message is discarded
+    };
+
+    // async backend options; enabled == false keeps the synchronous per-line flush behaviour
+    struct logAsyncConfig
+    {
+        bool enabled = false;
+        size_t queue_size = 8192;       // queued messages shared by all loggers
+        size_t thread_count = 1;        // backend writer threads
+        logOverflowPolicy overflow = logOverflowPolicy::block;
+        int flush_interval_ms = 1000;   // periodic flush of every logger, <= 0 disables it
+    };
+
     struct logConfig
     {
         size_t max_file_size;
@@ -58,6 +58,13 @@ myLogger* myLogger::get_instance(log_source_type log_type)
 }
 
 
+void myLogger::log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite,
+                        const logAsyncConfig& async_config)
+{
+    CHECK(handler);
+    handler->log_init(dir, max_size, max_file, overwrite, async_config);
+}
+
 void myLogger::mylog_write(logType type, logLevel level, const std::string& msg, const std::string& msg_with_file_info)
 {
     CHECK(handler);
@@ -78,6 +85,21 @@ bool myLogger::contains(logType type)
     return handler->contains(type);
 }
 
+bool myLogger::should_log(const std::string& type, logLevel level)
+{
+    if (!handler)
+    {
+        return false;
+    }
+    return handler->should_log(type, level);
+}
+
+void myLogger::set_level(const std::string& type, logLevel level)
+{
+    CHECK(handler);
+    handler->set_level(type, level);
+}
+
 bool myLogger::regist_log(logType type, std::string filename)
 {
     CHECK_BOOL2(handler, type);
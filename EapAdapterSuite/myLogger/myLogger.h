@@ -19,9 +19,15 @@ namespace myLog
         ~myLogger() override;
         static myLogger* get_instance(log_source_type log_type = log_source_type::log_spd);
 
+        // select the log backend mode; call early, before other threads start logging
+        void log_init(const std::string& dir, size_t max_size, int max_file, bool overwrite,
+                      const logAsyncConfig& async_config);
+
         void mylog_write(logType type, logLevel level, const std::string& msg, const std::string& msg_with_file_info);
         void mylog_write(const std::string& type, logLevel level, const std::string& msg, const std::string& msg_with_file_info);
         bool contains(logType type);
+        bool should_log(const std::string& type, logLevel level);
+        void set_level(const std::string& type, logLevel level);
 
         bool regist_log(logType type, std::string filename);
         bool regist_log(const std::string& type, std::string filename);